@@ -0,0 +1,6 @@
+# CMake generated Testfile for 
+# Source directory: /tmp/catchshim
+# Build directory: /root/repo/_warn_build/_deps/catch-build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
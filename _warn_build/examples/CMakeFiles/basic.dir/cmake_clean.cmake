@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic.dir/basic.cpp.o"
+  "CMakeFiles/basic.dir/basic.cpp.o.d"
+  "basic"
+  "basic.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
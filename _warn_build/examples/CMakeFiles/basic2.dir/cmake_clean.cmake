@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/basic2.dir/basic2.cpp.o"
+  "CMakeFiles/basic2.dir/basic2.cpp.o.d"
+  "basic2"
+  "basic2.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/basic2.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/multiple_worlds.dir/multiple_worlds.cpp.o"
+  "CMakeFiles/multiple_worlds.dir/multiple_worlds.cpp.o.d"
+  "multiple_worlds"
+  "multiple_worlds.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/multiple_worlds.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
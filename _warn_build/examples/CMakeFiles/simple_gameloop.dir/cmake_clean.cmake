@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/simple_gameloop.dir/simple_gameloop.cpp.o"
+  "CMakeFiles/simple_gameloop.dir/simple_gameloop.cpp.o.d"
+  "simple_gameloop"
+  "simple_gameloop.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/simple_gameloop.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
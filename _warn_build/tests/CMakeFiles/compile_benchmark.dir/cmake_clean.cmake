@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/compile_benchmark.dir/compile_benchmark.cpp.o"
+  "CMakeFiles/compile_benchmark.dir/compile_benchmark.cpp.o.d"
+  "compile_benchmark"
+  "compile_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/compile_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
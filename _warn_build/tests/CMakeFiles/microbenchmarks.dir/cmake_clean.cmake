@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/microbenchmarks.dir/ecs.microbenchmark.cpp.o"
+  "CMakeFiles/microbenchmarks.dir/ecs.microbenchmark.cpp.o.d"
+  "microbenchmarks"
+  "microbenchmarks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/microbenchmarks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
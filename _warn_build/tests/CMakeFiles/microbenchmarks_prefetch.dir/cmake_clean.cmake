@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/microbenchmarks_prefetch.dir/ecs.microbenchmark.cpp.o"
+  "CMakeFiles/microbenchmarks_prefetch.dir/ecs.microbenchmark.cpp.o.d"
+  "microbenchmarks_prefetch"
+  "microbenchmarks_prefetch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/microbenchmarks_prefetch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
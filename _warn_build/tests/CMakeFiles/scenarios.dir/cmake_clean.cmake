@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/scenarios.dir/ecs.scenarios.cpp.o"
+  "CMakeFiles/scenarios.dir/ecs.scenarios.cpp.o.d"
+  "scenarios"
+  "scenarios.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/scenarios.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tests_unchecked.dir/main.test.cpp.o"
+  "CMakeFiles/tests_unchecked.dir/main.test.cpp.o.d"
+  "tests_unchecked"
+  "tests_unchecked.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tests_unchecked.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_warn_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test "/root/repo/_warn_build/tests/tests")
+set_tests_properties(test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;16;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(test_unchecked "/root/repo/_warn_build/tests/tests_unchecked")
+set_tests_properties(test_unchecked PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;22;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(benchmark "/root/repo/_warn_build/tests/benchmarks")
+set_tests_properties(benchmark PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;26;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(microbenchmark "/root/repo/_warn_build/tests/microbenchmarks" "--repetitions=2" "--warmup=0" "--min-time=0" "--filter=/entities:1000(/|\$)")
+set_tests_properties(microbenchmark PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;31;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(microbenchmark_prefetch "/root/repo/_warn_build/tests/microbenchmarks_prefetch" "--repetitions=2" "--warmup=0" "--min-time=0" "--filter=ForEachShuffled/entities:1000\$")
+set_tests_properties(microbenchmark_prefetch PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;37;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(scenarios "/root/repo/_warn_build/tests/scenarios" "--repetitions=2" "--warmup=0" "--min-time=0" "--filter=/entities:1000\$")
+set_tests_properties(scenarios PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;43;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(compile_benchmark "/root/repo/_warn_build/tests/compile_benchmark" "--counts=16" "--repetitions=1")
+set_tests_properties(compile_benchmark PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;57;add_test;/root/repo/tests/CMakeLists.txt;0;")
+subdirs("../_deps/catch-build")
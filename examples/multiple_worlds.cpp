@@ -0,0 +1,65 @@
+#include <easys/easys.hpp>
+#include <easys/job_system.hpp>
+#include <iostream>
+#include <vector>
+
+// This example runs many independent worlds, e.g. one per match on a game server, on one shared JobSystem. Creating
+// a world does not allocate, so matches can be started and ended cheaply. Every world is updated by exactly one job
+// per frame, which is all the synchronization an ECS needs.
+
+struct Position {
+	float x, y;
+};
+
+struct Velocity {
+	float dx, dy;
+};
+
+using World = Easys::ECS<Position, Velocity>;
+
+void spawnPlayers(World& world, int players)
+{
+	for (int i = 0; i < players; i++)
+	{
+		Easys::Entity e = world.addEntity();
+		world.addComponent(e, Position{0.0f, 0.0f});
+		world.addComponent(e, Velocity{1.0f, static_cast<float>(i)});
+	}
+}
+
+void update(World& world)
+{
+	world.runSystem("movement",
+	                [](World& w)
+	                {
+		                w.forEach<Position, Velocity>(
+		                    [](Easys::Entity, Position& pos, const Velocity& vel)
+		                    {
+			                    pos.x += vel.dx;
+			                    pos.y += vel.dy;
+		                    });
+	                });
+}
+
+int main()
+{
+	Easys::JobSystem jobs;
+	std::vector<World> matches(200);
+	for (auto& match : matches) spawnPlayers(match, 10);
+
+	for (int frame = 0; frame < 60; frame++)
+	{
+		jobs.forEach(matches, update);
+
+		// Every 20 frames a match ends and a new one starts in its place
+		if (frame % 20 == 19)
+		{
+			matches.front() = World();
+			spawnPlayers(matches.front(), 10);
+		}
+	}
+
+	std::cout << "Updated " << matches.size() << " worlds on " << jobs.workerCount() + 1 << " threads, player 9 of "
+	          << "the last match is at x=" << matches.back().getComponent<Position>(9).x << "\n";
+	return 0;
+}
@@ -0,0 +1,82 @@
+#define EASYS_PROFILING 1
+
+#include <easys/easys.hpp>
+#include <fstream>
+#include <iostream>
+
+// This example demonstrates the built-in profiler. With EASYS_PROFILING enabled, every runSystem() and forEach()
+// call is recorded together with the number of visited entities and structural changes. The recorded events can be
+// exported as a Chrome trace and inspected in chrome://tracing or https://ui.perfetto.dev.
+
+struct Position {
+	float x, y;
+};
+
+struct Velocity {
+	float dx, dy;
+};
+
+struct Lifetime {
+	int frames;
+};
+
+using ECS = Easys::ECS<Position, Velocity, Lifetime>;
+
+void movementSystem(ECS& ecs)
+{
+	ecs.forEach<Position, Velocity>(
+	    [](Easys::Entity, Position& pos, const Velocity& vel)
+	    {
+		    pos.x += vel.dx;
+		    pos.y += vel.dy;
+	    });
+}
+
+void lifetimeSystem(ECS& ecs)
+{
+	std::vector<Easys::Entity> expired;
+	ecs.forEach<Lifetime>(
+	    [&expired](Easys::Entity e, Lifetime& lifetime)
+	    {
+		    if (--lifetime.frames <= 0) expired.push_back(e);
+	    });
+	ecs.removeEntities(expired);
+}
+
+void spawnSystem(ECS& ecs)
+{
+	for (int i = 0; i < 100; i++)
+	{
+		Easys::Entity e = ecs.addEntity();
+		ecs.addComponent(e, Position{0.0f, 0.0f});
+		ecs.addComponent(e, Velocity{1.0f, 0.5f});
+		ecs.addComponent(e, Lifetime{10 + i % 20});
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	ECS ecs;
+
+	for (int frame = 0; frame < 60; frame++)
+	{
+		ecs.runSystem("spawn", spawnSystem);
+		ecs.runSystem("movement", movementSystem);
+		ecs.runSystem("lifetime", lifetimeSystem);
+		ecs.endFrame();
+	}
+
+	for (const Easys::ProfileEvent& event : ecs.getProfiler().events())
+	{
+		if (event.type != Easys::ProfileEventType::System) continue;
+		std::cout << event.name << ": " << event.duration / 1000.0 << " us, " << event.entities << " entities, "
+		          << event.structuralChanges << " structural changes" << std::endl;
+	}
+
+	const char* path = argc > 1 ? argv[1] : "easys_trace.json";
+	std::ofstream file(path);
+	ecs.getProfiler().writeChromeTrace(file);
+	std::cout << "Trace written to " << path << std::endl;
+
+	return 0;
+}
@@ -17,14 +17,13 @@ using ECS = Easys::ECS<Position, Velocity>;
 struct System {
 	void update(ECS& ecs)
 	{
-		for (Easys::Entity e : ecs.getEntitiesByComponents<Position, Velocity>())
-		{
-			Position& pos = ecs.getComponent<Position>(e);
-			const Velocity& vel = ecs.getComponent<Velocity>(e);
-
-			pos.x += vel.vx;
-			pos.y += vel.vy;
-		}
+		// forEach looks up the components itself, and prefetches them ahead if EASYS_PREFETCH_DISTANCE > 0
+		ecs.forEach<Position, const Velocity>(
+		    [](Easys::Entity, Position& pos, const Velocity& vel)
+		    {
+			    pos.x += vel.vx;
+			    pos.y += vel.vy;
+		    });
 	}
 };
 
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Easys {
+
+// A vector-like container which stores its elements in fixed size chunks. Unlike std::vector, growing the container
+// never moves existing elements, so references and pointers to elements stay valid until the element itself is
+// removed. Only the operations needed by SparseSet are provided.
+template <typename T, size_t ChunkSize = 1024>
+class ChunkedVector {
+	static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two.");
+
+   private:
+	struct Chunk {
+		alignas(T) std::byte data[sizeof(T) * ChunkSize];
+	};
+
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	size_t count = 0;
+
+	inline T* slot(const size_t index) const
+	{
+		std::byte* chunkData = chunks[index / ChunkSize]->data;
+		return std::launder(reinterpret_cast<T*>(chunkData + (index % ChunkSize) * sizeof(T)));
+	}
+
+	inline void ensureSlot()
+	{
+		if (count == capacity())
+		{
+			// Default-initialize on purpose, the chunk memory does not need to be zeroed.
+			chunks.push_back(std::unique_ptr<Chunk>(new Chunk));
+		}
+	}
+
+   public:
+	using value_type = T;
+	using size_type = size_t;
+
+	static constexpr size_t chunkSize = ChunkSize;
+
+	ChunkedVector() = default;
+
+	// Delegates first, so that the destructor cleans up the copied elements if one of the copies throws
+	ChunkedVector(const ChunkedVector& other) : ChunkedVector()
+	{
+		reserve(other.count);
+		for (size_t i = 0; i < other.count; i++) push_back(other[i]);
+	}
+
+	ChunkedVector(ChunkedVector&& other) noexcept
+	    : chunks(std::move(other.chunks)), count(std::exchange(other.count, 0))
+	{
+	}
+
+	ChunkedVector& operator=(ChunkedVector other) noexcept
+	{
+		std::swap(chunks, other.chunks);
+		std::swap(count, other.count);
+		return *this;
+	}
+
+	~ChunkedVector() { clear(); }
+
+	inline T& operator[](const size_t index) { return *slot(index); }
+	inline const T& operator[](const size_t index) const { return *slot(index); }
+
+	inline T& back() { return *slot(count - 1); }
+	inline const T& back() const { return *slot(count - 1); }
+
+	inline void push_back(const T& value)
+	{
+		ensureSlot();
+		::new (static_cast<void*>(slot(count))) T(value);
+		count++;
+	}
+
+	inline void push_back(T&& value)
+	{
+		ensureSlot();
+		::new (static_cast<void*>(slot(count))) T(std::move(value));
+		count++;
+	}
+
+	inline void pop_back()
+	{
+		count--;
+		std::destroy_at(slot(count));
+	}
+
+	// Destroys all elements but keeps the allocated chunks, like std::vector::clear()
+	inline void clear()
+	{
+		for (size_t i = 0; i < count; i++) std::destroy_at(slot(i));
+		count = 0;
+	}
+
+	inline void reserve(const size_t n)
+	{
+		while (capacity() < n) chunks.push_back(std::unique_ptr<Chunk>(new Chunk));
+	}
+
+	// Frees all chunks that do not hold any elements
+	inline void shrink_to_fit()
+	{
+		chunks.resize((count + ChunkSize - 1) / ChunkSize);
+		chunks.shrink_to_fit();
+	}
+
+	constexpr size_t size() const noexcept { return count; }
+	constexpr bool empty() const noexcept { return count == 0; }
+	constexpr size_t capacity() const noexcept { return chunks.size() * ChunkSize; }
+
+	constexpr size_t max_size() const noexcept
+	{
+		return static_cast<size_t>(std::numeric_limits<std::ptrdiff_t>::max()) / sizeof(T);
+	}
+};
+
+}  // namespace Easys
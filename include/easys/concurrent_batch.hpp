@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "entity.hpp"
+
+namespace Easys {
+
+// A fixed capacity buffer that many threads can append to without locks. A slot is reserved with a single atomic
+// increment and only written by the thread that reserved it. Reading the contents requires that all appends
+// happened before, e.g. the producing threads were joined.
+template <typename T>
+class ConcurrentAppendBuffer {
+   public:
+	explicit ConcurrentAppendBuffer(const size_t capacity)
+	    : capacity_(capacity), slots(capacity > 0 ? std::make_unique<Slot[]>(capacity) : nullptr)
+	{
+	}
+
+	ConcurrentAppendBuffer(const ConcurrentAppendBuffer&) = delete;
+	ConcurrentAppendBuffer& operator=(const ConcurrentAppendBuffer&) = delete;
+
+	~ConcurrentAppendBuffer() { clear(); }
+
+	// Thread-safe. Throws std::length_error once the capacity is exhausted.
+	template <typename... Args>
+	inline T& emplace(Args&&... args)
+	{
+		const size_t index = reserved.fetch_add(1, std::memory_order_relaxed);
+		if (index >= capacity_) throw std::length_error("Concurrent insertion capacity exceeded.");
+
+		Slot& slot = slots[index];
+		T* value = ::new (slot.storage) T(std::forward<Args>(args)...);
+		slot.constructed = true;  // only set once the constructor did not throw
+		return *value;
+	}
+
+	inline size_t capacity() const { return capacity_; }
+
+	// Number of reserved slots. Slots whose value threw on construction are counted, but skipped by forEach().
+	inline size_t size() const { return std::min(reserved.load(std::memory_order_acquire), capacity_); }
+
+	// Calls func(T&) for every appended value. Not thread-safe.
+	template <typename Func>
+	inline void forEach(Func&& func)
+	{
+		const size_t n = size();
+		for (size_t i = 0; i < n; i++)
+		{
+			if (slots[i].constructed) func(*std::launder(reinterpret_cast<T*>(slots[i].storage)));
+		}
+	}
+
+	// Not thread-safe
+	inline void clear()
+	{
+		forEach([](T& value) { value.~T(); });
+		for (size_t i = 0; i < size(); i++) slots[i].constructed = false;
+		reserved.store(0, std::memory_order_relaxed);
+	}
+
+   private:
+	struct Slot {
+		alignas(T) std::byte storage[sizeof(T)];
+		bool constructed = false;
+	};
+
+	size_t capacity_;
+	std::unique_ptr<Slot[]> slots;
+	std::atomic<size_t> reserved = 0;
+};
+
+// Collects new entities and components from many threads at once, e.g. asset streaming threads that attach
+// components while the main thread keeps simulating. Created by ECS::beginConcurrentInsert(), which reserves the
+// entity IDs up front, and merged into the ECS by ECS::commit().
+//
+// Contract: addEntity() and addComponent() may be called from any number of threads at the same time, also while
+// the thread owning the ECS iterates or modifies it, because a batch does not touch the ECS. New entities and
+// components become visible at commit(), which must run on the thread owning the ECS after all producers finished.
+template <typename... Components>
+class ConcurrentBatch {
+   public:
+	template <typename Component>
+	struct Entry {
+		Entity entity;
+		Component component;
+	};
+
+	// The generation identifies the state of the ECS the IDs were reserved from, see ECS::commit()
+	ConcurrentBatch(std::vector<Entity> ids, const size_t componentCapacity, const uint64_t generation = 0)
+	    : ids_(std::move(ids)), generation_(generation), components_(((void)sizeof(Components), componentCapacity)...)
+	{
+	}
+
+	ConcurrentBatch(const ConcurrentBatch&) = delete;
+	ConcurrentBatch& operator=(const ConcurrentBatch&) = delete;
+
+	// Thread-safe. Hands out one of the reserved IDs, throws std::length_error once all of them are used.
+	inline Entity addEntity()
+	{
+		const size_t index = used_.fetch_add(1, std::memory_order_relaxed);
+		if (index >= ids_.size()) throw std::length_error("No reserved entity IDs left in the batch.");
+		return ids_[index];
+	}
+
+	// Thread-safe. The entity may be one of the batch or an existing one. If the entity has been removed by the time
+	// the batch is committed, the component is dropped.
+	template <typename Component>
+	inline void addComponent(const Entity entity, Component component)
+	{
+		buffer<Component>().emplace(entity, std::move(component));
+	}
+
+	// The IDs handed out by addEntity(). Not thread-safe.
+	inline std::span<const Entity> usedEntities() const
+	{
+		return std::span<const Entity>(ids_).first(std::min(used_.load(std::memory_order_acquire), ids_.size()));
+	}
+
+	// The reserved IDs that were not handed out. Not thread-safe.
+	inline std::span<const Entity> unusedEntities() const
+	{
+		return std::span<const Entity>(ids_).subspan(usedEntities().size());
+	}
+
+	inline uint64_t generation() const { return generation_; }
+
+	template <typename Component>
+	inline ConcurrentAppendBuffer<Entry<Component>>& buffer()
+	{
+		return std::get<ConcurrentAppendBuffer<Entry<Component>>>(components_);
+	}
+
+	// Forget all entities and components, e.g. after a commit. Not thread-safe.
+	inline void clear()
+	{
+		ids_.clear();
+		used_.store(0, std::memory_order_relaxed);
+		std::apply([](auto&... buffers) { (buffers.clear(), ...); }, components_);
+	}
+
+   private:
+	std::vector<Entity> ids_;
+	std::atomic<size_t> used_ = 0;
+	uint64_t generation_;
+	std::tuple<ConcurrentAppendBuffer<Entry<Components>>...> components_;
+};
+
+}  // namespace Easys
@@ -21,4 +21,73 @@
  */
 #ifndef EASYS_ENTITY_LIMIT
 #define EASYS_ENTITY_LIMIT 10000
-#endif
\ No newline at end of file
+#endif
+
+/**
+ * @def EASYS_CHECKED
+ * @brief Enables presence checks on component access.
+ * @details When set to `1`, `getComponent` verifies that the entity owns the requested component and throws a
+ * `KeyNotFoundException` otherwise. When set to `0`, these checks are compiled out and replaced by debug assertions,
+ * so accessing a missing component is undefined behaviour in release builds. Defaults to `1` regardless of `NDEBUG`,
+ * so that `getComponent` throws the same way in debug and release builds; define it as `0` for release builds that
+ * should skip the checks.
+ */
+#ifndef EASYS_CHECKED
+#define EASYS_CHECKED 1
+#endif
+
+/**
+ * @def EASYS_PROFILING
+ * @brief Enables the built-in profiler.
+ * @details When set to `1`, every ECS records the duration of `runSystem()` and `forEach()` calls, the number of
+ * entities they visit and the number of structural changes (entity and component additions and removals) into a
+ * lock-free ring buffer, which can be exported with `getProfiler().writeChromeTrace()`. When set to `0`, all
+ * instrumentation is compiled out. Defaults to `0`.
+ */
+#ifndef EASYS_PROFILING
+#define EASYS_PROFILING 0
+#endif
+
+/**
+ * @def EASYS_ACCESS_CHECKS
+ * @brief Detects conflicting concurrent access to component pools.
+ * @details When set to `1`, every component pool tracks the threads reading and writing it while `forEach()`, the
+ * component add/remove paths and `lock()` guards run. A thread that writes a pool while another thread reads or writes
+ * it aborts with the name of the component type. When set to `0`, the tracking is compiled out. Defaults to `1` in
+ * debug builds (`NDEBUG` not defined) and to `0` otherwise.
+ * @warning The setting changes the layout of every component pool. All translation units of a program have to agree
+ * on it, otherwise they disagree on the layout of `Registry` and `ECS`, which is an ODR violation. Programs that mix
+ * debug and release translation units, e.g. an optimized library linked into a debug build, have to define
+ * `EASYS_ACCESS_CHECKS` (and `EASYS_POOL_LOCKS`) explicitly instead of relying on the `NDEBUG` based default.
+ */
+#ifndef EASYS_ACCESS_CHECKS
+#ifdef NDEBUG
+#define EASYS_ACCESS_CHECKS 0
+#else
+#define EASYS_ACCESS_CHECKS 1
+#endif
+#endif
+
+/**
+ * @def EASYS_POOL_LOCKS
+ * @brief Turns the access tracking of component pools into a reader/writer lock per pool.
+ * @details When set to `1`, a conflicting access waits until the pool is free instead of aborting, so that systems
+ * on different threads can share component types safely. Takes precedence over `EASYS_ACCESS_CHECKS`. Defaults to
+ * `0`.
+ */
+#ifndef EASYS_POOL_LOCKS
+#define EASYS_POOL_LOCKS 0
+#endif
+
+/**
+ * @def EASYS_PREFETCH_DISTANCE
+ * @brief How many entities ahead `forEach()` prefetches the components of the pools it looks up.
+ * @details Looking up a component is two dependent loads, the sparse slot of the entity and then the value. While
+ * iterating, the sparse slots are prefetched this many entities ahead and the values half as many, so that both loads
+ * hit the cache once the entity is reached. The pool being walked is not prefetched. When set to `0`, no prefetches
+ * are issued. Defaults to `0` until a gain is measured: compare `BM_ForEachShuffled` of the `microbenchmarks` and
+ * `microbenchmarks_prefetch` targets, the latter built with a distance of `32`.
+ */
+#ifndef EASYS_PREFETCH_DISTANCE
+#define EASYS_PREFETCH_DISTANCE 0
+#endif
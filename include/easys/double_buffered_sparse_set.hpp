@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "memory_stats.hpp"
+#include "sparse_set.hpp"
+
+namespace Easys {
+
+// A pool holding two values per key: the back buffer, which all regular accessors read and write, and the front
+// buffer, which keeps the values of the last swapBuffers() call, e.g. last tick's positions for a render thread.
+// The back buffer is the value array of a SparseSet, the front buffer a second array parallel to it. Every structural
+// change moves the elements of both arrays together, so they always share the one entity mapping. The buffers live in
+// separate allocations, so a thread writing back values and another one reading front values do not contend for the
+// same cache lines. swapBuffers() swaps the two arrays, so no values are copied.
+//
+// After a swap the back buffer holds the values from two swaps ago. Systems that write a double buffered type should
+// therefore compute every value from the front buffer (e.g. back = front + velocity) instead of updating it in place.
+// Adding a value sets both buffers.
+template <UnsignedIntegral Key, typename Value>
+class DoubleBufferedSparseSet {
+   public:
+	inline void set(const Key key, const Value& value)
+	{
+		if (Value* back = pool.tryGet(key))
+		{
+			*back = value;
+			return;
+		}
+		front.push_back(value);
+		try
+		{
+			pool.set(key, value);
+		} catch (...)
+		{
+			front.pop_back();
+			throw;
+		}
+	}
+
+	inline void set(const Key key, Value&& value)
+	{
+		if (Value* back = pool.tryGet(key))
+		{
+			*back = std::move(value);
+			return;
+		}
+		front.push_back(value);
+		try
+		{
+			pool.set(key, std::move(value));
+		} catch (...)
+		{
+			front.pop_back();
+			throw;
+		}
+	}
+
+	// Existing keys only get their back buffer updated, so this is not forwarded to the bulk set of the pool
+	inline void set(std::span<const Key> keys, const Value& value)
+	{
+		for (const Key key : keys) set(key, value);
+	}
+
+	// The back buffer
+	inline const Value& get(const Key key) const { return pool.get(key); }
+	inline Value& get(const Key key) { return pool.get(key); }
+	inline const Value* tryGet(const Key key) const { return pool.tryGet(key); }
+	inline Value* tryGet(const Key key) { return pool.tryGet(key); }
+	inline const Value& operator[](const Key key) const { return pool[key]; }
+	inline Value& operator[](const Key key) { return pool[key]; }
+
+	// The value of the last swapBuffers() call
+	inline const Value& getFront(const Key key) const
+	{
+		(void)pool.get(key);  // the same presence check as get()
+		return front[pool.indexOf(key)];
+	}
+
+	// Calls func(key, const Value&) for the front buffer of every key
+	template <typename Func>
+	inline void forEachFront(Func&& func) const
+	{
+		const std::vector<Key>& keys = pool.getKeys();
+		for (size_t i = 0; i < keys.size(); i++) func(keys[i], front[i]);
+	}
+
+	// Publish the back buffer as the new front buffer. O(1).
+	inline void swapBuffers() { std::swap(pool.getValues(), front); }
+
+	inline void remove(const Key key) { pool.remove(key, front); }
+	inline void remove(std::span<const Key> keys, const bool preserveOrder = false)
+	{
+		pool.remove(keys, preserveOrder, front);
+	}
+	inline void reorder(std::span<const Key> order) { pool.reorder(order, front); }
+
+	// Sorts by the back buffer, both values of a key move together
+	template <typename Compare>
+	inline void sort(Compare compare)
+	{
+		pool.sort(compare, front);
+	}
+
+	inline bool contains(const Key key) const { return pool.contains(key); }
+	inline void prefetchKey(const Key key) const { pool.prefetchKey(key); }
+	inline void prefetchValue(const Key key) const { pool.prefetchValue(key); }
+	inline bool aliases(std::span<const Key> keys) const { return pool.aliases(keys); }
+	inline size_t size() const { return pool.size(); }
+	inline const std::vector<Key>& getKeys() const { return pool.getKeys(); }
+
+	inline void clear()
+	{
+		pool.clear();
+		front.clear();
+	}
+
+	inline void reserve(const size_t n)
+	{
+		pool.reserve(n);
+		front.reserve(n);
+	}
+
+	inline void reserveKeys(const size_t n) { pool.reserveKeys(n); }
+	inline size_t capacity() const { return pool.capacity(); }
+
+	inline PoolMemoryStats memoryStats() const
+	{
+		PoolMemoryStats stats = pool.memoryStats();
+		stats.valuesUsed += front.size() * sizeof(Value);
+		stats.valuesReserved += front.capacity() * sizeof(Value);
+		return stats;
+	}
+
+	inline void shrinkToFit()
+	{
+		pool.shrinkToFit();
+		front.shrink_to_fit();
+	}
+
+   private:
+	SparseSet<Key, Value> pool;  // the mapping and the back buffer
+	std::vector<Value> front;    // parallel to the values of pool
+};
+
+}  // namespace Easys
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "memory_stats.hpp"
+#include "sparse_set.hpp"
+
+namespace Easys {
+
+// Identifies a component type registered at runtime, see Registry::registerComponent()
+enum class ComponentId : uint32_t {};
+
+// Describes the memory layout and lifetime of a component type that is only known at runtime, e.g. one defined by a
+// script. The hooks may be left empty for trivial types: values are then zero-initialized, copied and moved with
+// memcpy and not destroyed. Without a move hook, values are moved by copying them and destroying the source.
+// The construct and copy hooks may throw, the set is left unchanged then. Moves (the move hook, or the copy hook when
+// there is none) replace a value in place and must not throw there.
+struct ComponentDescriptor {
+	std::string name;
+	size_t size = 0;
+	size_t alignment = alignof(std::max_align_t);
+
+	void (*construct)(void* dst) = nullptr;              // default-construct into uninitialized memory
+	void (*copy)(void* dst, const void* src) = nullptr;  // copy-construct into uninitialized memory
+	void (*move)(void* dst, void* src) = nullptr;        // move-construct into uninitialized memory
+	void (*destroy)(void* value) = nullptr;
+
+	// A descriptor for a C++ type, mostly useful for native types that are shared with scripts and for tests
+	template <typename T>
+	static ComponentDescriptor of(std::string name)
+	{
+		ComponentDescriptor descriptor{std::move(name), sizeof(T), alignof(T)};
+		if constexpr (!std::is_trivially_default_constructible_v<T>)
+		{
+			descriptor.construct = [](void* dst) { ::new (dst) T(); };
+		}
+		if constexpr (!std::is_trivially_copyable_v<T>)
+		{
+			descriptor.copy = [](void* dst, const void* src) { ::new (dst) T(*static_cast<const T*>(src)); };
+			descriptor.move = [](void* dst, void* src) { ::new (dst) T(std::move(*static_cast<T*>(src))); };
+		}
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			descriptor.destroy = [](void* value) { static_cast<T*>(value)->~T(); };
+		}
+		return descriptor;
+	}
+};
+
+// A type-erased counterpart of SparseSet for component types described at runtime. It uses the same sparse/dense
+// layout and swap-and-pop removal, the values are stored back to back in a single aligned buffer with a stride of
+// the descriptor's size rounded up to its alignment.
+template <UnsignedIntegral Key>
+class DynamicSparseSet {
+   private:
+	ComponentDescriptor descriptor_;
+	size_t stride = 0;
+
+	std::vector<Key> sparse;  // Large, indexed by keys
+	std::vector<Key> dense;   // Compact, stores keys
+	std::byte* values = nullptr;  // Parallel to dense, stores values
+	size_t valueCapacity = 0;
+
+	inline std::byte* slot(const size_t index) const { return values + index * stride; }
+
+	inline void constructCopy(void* dst, const void* src) const
+	{
+		if (descriptor_.copy)
+			descriptor_.copy(dst, src);
+		else
+			std::memcpy(dst, src, descriptor_.size);
+	}
+
+	// The source is destroyed by the caller afterwards
+	inline void constructMove(void* dst, void* src) const
+	{
+		if (descriptor_.move)
+			descriptor_.move(dst, src);
+		else
+			constructCopy(dst, src);
+	}
+
+	inline void constructDefault(void* dst) const
+	{
+		if (descriptor_.construct)
+			descriptor_.construct(dst);
+		else
+			std::memset(dst, 0, descriptor_.size);
+	}
+
+	inline void destroy(void* value) const
+	{
+		if (descriptor_.destroy) descriptor_.destroy(value);
+	}
+
+	// Move all values into a new buffer with room for n values. The old values are destroyed only once all of them
+	// were moved, so a throwing hook leaves the set unchanged.
+	inline void reallocate(const size_t n)
+	{
+		std::byte* buffer = allocate(n);
+		size_t moved = 0;
+		try
+		{
+			for (; moved < dense.size(); moved++) constructMove(buffer + moved * stride, slot(moved));
+		} catch (...)
+		{
+			for (size_t i = 0; i < moved; i++) destroy(buffer + i * stride);
+			deallocate(buffer);
+			throw;
+		}
+		for (size_t i = 0; i < dense.size(); i++) destroy(slot(i));
+		deallocate(values);
+		values = buffer;
+		valueCapacity = n;
+	}
+
+	// Replace the value in a live slot. A value built by a hook is built aside first, so that the slot keeps its old
+	// value if the hook throws.
+	inline void replace(void* existing, const void* value)
+	{
+		if (value ? !descriptor_.copy : !descriptor_.construct)
+		{
+			destroy(existing);
+			value ? constructCopy(existing, value) : constructDefault(existing);
+			return;
+		}
+
+		std::byte* temporary = allocate(1);
+		try
+		{
+			value ? constructCopy(temporary, value) : constructDefault(temporary);
+		} catch (...)
+		{
+			deallocate(temporary);
+			throw;
+		}
+		destroy(existing);
+		constructMove(existing, temporary);
+		destroy(temporary);
+		deallocate(temporary);
+	}
+
+	inline std::byte* allocate(const size_t n) const
+	{
+		if (n == 0) return nullptr;
+		return static_cast<std::byte*>(::operator new(n * stride, std::align_val_t(descriptor_.alignment)));
+	}
+
+	inline void deallocate(std::byte* buffer) const
+	{
+		if (buffer) ::operator delete(buffer, std::align_val_t(descriptor_.alignment));
+	}
+
+	inline void deallocate()
+	{
+		deallocate(values);
+		values = nullptr;
+		valueCapacity = 0;
+	}
+
+	// Ensure the sparse array can accommodate the given key
+	inline void accommodate(const Key key)
+	{
+		if (key >= std::numeric_limits<Key>::max())
+		{
+			throw std::length_error("Key exceeds the maximum size limit.");
+		}
+
+		if (key >= sparse.size())
+		{
+			sparse.resize(key * 2 + 1, std::numeric_limits<Key>::max());
+		}
+	}
+
+   public:
+	explicit DynamicSparseSet(ComponentDescriptor descriptor) : descriptor_(std::move(descriptor))
+	{
+		if (descriptor_.alignment == 0 || (descriptor_.alignment & (descriptor_.alignment - 1)) != 0)
+		{
+			throw std::invalid_argument("Component alignment must be a power of two.");
+		}
+		// Every value is at least one byte, so that each key gets its own address
+		const size_t size = std::max<size_t>(descriptor_.size, 1);
+		stride = (size + descriptor_.alignment - 1) / descriptor_.alignment * descriptor_.alignment;
+	}
+
+	DynamicSparseSet(const DynamicSparseSet& other)
+	    : descriptor_(other.descriptor_), stride(other.stride), sparse(other.sparse)
+	{
+		reserve(other.size());
+		try
+		{
+			for (size_t i = 0; i < other.dense.size(); i++)
+			{
+				constructCopy(slot(i), other.slot(i));
+				dense.push_back(other.dense[i]);
+			}
+		} catch (...)
+		{
+			// The destructor does not run for a throwing constructor
+			clear();
+			deallocate();
+			throw;
+		}
+	}
+
+	DynamicSparseSet(DynamicSparseSet&& other) noexcept
+	    : descriptor_(std::move(other.descriptor_)),
+	      stride(other.stride),
+	      sparse(std::move(other.sparse)),
+	      dense(std::move(other.dense)),
+	      values(std::exchange(other.values, nullptr)),
+	      valueCapacity(std::exchange(other.valueCapacity, 0))
+	{
+		other.dense.clear();
+	}
+
+	DynamicSparseSet& operator=(DynamicSparseSet other) noexcept
+	{
+		std::swap(descriptor_, other.descriptor_);
+		std::swap(stride, other.stride);
+		std::swap(sparse, other.sparse);
+		std::swap(dense, other.dense);
+		std::swap(values, other.values);
+		std::swap(valueCapacity, other.valueCapacity);
+		return *this;
+	}
+
+	~DynamicSparseSet()
+	{
+		clear();
+		deallocate();
+	}
+
+	inline const ComponentDescriptor& descriptor() const { return descriptor_; }
+
+	// Associate a copy of *value with a key, or a default-constructed value if value is nullptr. Returns the stored
+	// value.
+	inline void* set(const Key key, const void* value = nullptr)
+	{
+		if (contains(key))
+		{
+			void* existing = slot(sparse[key]);
+			if (value == existing) return existing;
+			replace(existing, value);
+			return existing;
+		}
+
+		accommodate(key);
+		if (dense.size() == valueCapacity)
+		{
+			// The value may live in this set, e.g. set(b, get(a)), and would move with the buffer
+			const auto* source = static_cast<const std::byte*>(value);
+			const bool isOwnValue = source && std::less_equal<const std::byte*>{}(values, source)
+			                        && std::less<const std::byte*>{}(source, slot(dense.size()));
+			const size_t offset = isOwnValue ? static_cast<size_t>(source - values) : 0;
+
+			reallocate(std::max<size_t>(8, valueCapacity * 2));
+			if (isOwnValue) value = values + offset;
+		}
+
+		void* inserted = slot(dense.size());
+		value ? constructCopy(inserted, value) : constructDefault(inserted);
+		sparse[key] = static_cast<Key>(dense.size());
+		dense.push_back(key);
+		return inserted;
+	}
+
+	// Retrieve a value by key
+	inline void* get(const Key key)
+	{
+#if EASYS_CHECKED
+		if (!contains(key))
+		{
+			throw KeyNotFoundException(std::to_string(key));
+		}
+#else
+		assert(contains(key));
+#endif
+		return slot(sparse[key]);
+	}
+
+	inline const void* get(const Key key) const { return const_cast<DynamicSparseSet*>(this)->get(key); }
+
+	// Retrieve a value by key, or nullptr if the key is not set
+	inline void* tryGet(const Key key) { return contains(key) ? slot(sparse[key]) : nullptr; }
+	inline const void* tryGet(const Key key) const { return contains(key) ? slot(sparse[key]) : nullptr; }
+
+	// Retrieve a value by key without any checks. The key has to be set.
+	inline void* operator[](const Key key) { return slot(sparse[key]); }
+	inline const void* operator[](const Key key) const { return slot(sparse[key]); }
+
+	// Remove a value associated with a key by moving the last value into its slot
+	inline void remove(const Key key)
+	{
+		if (!contains(key)) return;
+
+		const size_t index = sparse[key];
+		const size_t last = dense.size() - 1;
+		destroy(slot(index));
+		if (index != last)
+		{
+			constructMove(slot(index), slot(last));
+			destroy(slot(last));
+			dense[index] = dense[last];
+			sparse[dense[index]] = static_cast<Key>(index);
+		}
+		dense.pop_back();
+		sparse[key] = std::numeric_limits<Key>::max();
+	}
+
+	inline bool contains(const Key key) const
+	{
+		return key < sparse.size() && sparse[key] != std::numeric_limits<Key>::max();
+	}
+
+	// Whether keys points into the key array of this set
+	inline bool aliases(std::span<const Key> keys) const
+	{
+		return !keys.empty() && std::less_equal<const Key*>{}(dense.data(), keys.data())
+		       && std::less<const Key*>{}(keys.data(), dense.data() + dense.size());
+	}
+
+	inline size_t size() const { return dense.size(); }
+
+	inline const std::vector<Key>& getKeys() const { return dense; }
+
+	inline void clear()
+	{
+		for (size_t i = 0; i < dense.size(); i++) destroy(slot(i));
+		sparse.clear();
+		dense.clear();
+	}
+
+	// Reserve room for n values so that the next n insertions do not reallocate
+	inline void reserve(const size_t n)
+	{
+		dense.reserve(n);
+		if (n > valueCapacity) reallocate(n);
+	}
+
+	// Size the sparse array up front so that keys below n never have to grow it
+	inline void reserveKeys(const size_t n)
+	{
+		if (n > sparse.size()) sparse.resize(n, std::numeric_limits<Key>::max());
+	}
+
+	inline size_t capacity() const { return valueCapacity; }
+
+	inline PoolMemoryStats memoryStats() const
+	{
+		PoolMemoryStats stats;
+		stats.sparseUsed = sparse.size() * sizeof(Key);
+		stats.sparseReserved = sparse.capacity() * sizeof(Key);
+		stats.denseUsed = dense.size() * sizeof(Key);
+		stats.denseReserved = dense.capacity() * sizeof(Key);
+		stats.valuesUsed = dense.size() * stride;
+		stats.valuesReserved = valueCapacity * stride;
+		stats.sparseFillRatio = sparse.empty() ? 0.0 : static_cast<double>(size()) / static_cast<double>(sparse.size());
+		return stats;
+	}
+
+	// Release unused memory. The sparse array is trimmed to the largest key still in use.
+	inline void shrinkToFit()
+	{
+		if (dense.empty())
+		{
+			sparse.clear();
+		} else
+		{
+			const Key maxKey = *std::max_element(dense.begin(), dense.end());
+			sparse.resize(static_cast<size_t>(maxKey) + 1);
+		}
+
+		sparse.shrink_to_fit();
+		dense.shrink_to_fit();
+		if (valueCapacity > dense.size()) reallocate(dense.size());
+	}
+};
+
+}  // namespace Easys
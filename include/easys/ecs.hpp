@@ -1,67 +1,95 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
-#include <queue>
+#include <optional>
 #include <set>
+#include <span>
+#include <string_view>
 
+#include "concurrent_batch.hpp"
+#include "dynamic_sparse_set.hpp"
 #include "entity.hpp"
+#include "entity_allocator.hpp"
+#include "hierarchy.hpp"
+#include "memory_stats.hpp"
+#include "prefab.hpp"
+#include "profiler.hpp"
 #include "registry.hpp"
+#include "resource.hpp"
+#include "task.hpp"
 
 namespace Easys {
 
 /**
  * @brief Manages entities and components in an Entity-Component-System architecture.
- * @tparam AllComponentTypes A list of all possible component types that can be used in this ECS instance.
+ * @tparam AllComponentTypes A list of all possible component types that can be used in this ECS instance. World-level
+ * resources can be declared anywhere in this list as Resources<...>, e.g. ECS<Position, Resources<Time>>.
  */
 template <typename... AllComponentTypes>
 class ECS {
    public:
 	/**
 	 * @brief Initializes the ECS with a predefined maximum number of entities (MAX_ENTITIES).
-	 * @details All entity IDs are initially available for assignment.
+	 * @details All entity IDs are initially available for assignment. No memory is allocated up front (except for the
+	 * profiler when EASYS_PROFILING is enabled), so creating and destroying an empty ECS is cheap, e.g. for one world
+	 * per match on a game server.
 	 */
-	ECS()
-	{
-		for (Entity entity = 0; entity < MAX_ENTITIES; entity++)
-		{
-			availableEntityIds_.push(entity);
-		}
-	}
+	ECS() = default;
+
+	/**
+	 * @brief Initializes the ECS with its own maximum number of entities.
+	 * @details Overrides MAX_ENTITIES (EASYS_ENTITY_LIMIT) for this world, so that small and large worlds can live in
+	 * one program. All entity IDs stay below the limit, which also bounds the sparse array of every pool.
+	 * @param entityLimit The maximum number of entities of this world.
+	 */
+	explicit ECS(const Entity entityLimit) : entityIds_(entityLimit) {}
+
+	/**
+	 * @brief Copies or moves a world.
+	 * @details Tasks keep references to the world they were spawned for, so a world with pending tasks can neither be
+	 * copied nor moved. The check runs before any component is touched, so the source stays intact.
+	 * @throws std::logic_error if the source has pending tasks.
+	 */
+	ECS(const ECS&) = default;
+	ECS(ECS&&) = default;
+	ECS& operator=(const ECS&) = default;
+	ECS& operator=(ECS&&) = default;
+
+	~ECS() { tasks_.clear(); }  // suspended tasks are destroyed before the pools
 
 	/**
 	 * @brief Initializes the ECS with a specific set of entities.
 	 * @details This constructor is useful for creating a new ECS instance based on a subset
 	 * of entities from another instance or a predefined list.
-	 * @param entities A set of entities to initialize the ECS with.
+	 * @param entities A set of entities to initialize the ECS with. Entities not below the limit are ignored.
+	 * @param entityLimit The maximum number of entities of this world.
 	 */
-	ECS(const std::set<Entity>& oldEntities)
+	ECS(const std::set<Entity>& oldEntities, const Entity entityLimit = MAX_ENTITIES)
+	    : entityIds_(oldEntities, entityLimit)
 	{
 		// I decided against an addEntity(Entity) method to discourage
 		//  tampering with entities too much. I think this really should be the ECS's
 		//  responsibility.
-		for (Entity entity = 0; entity < MAX_ENTITIES; entity++)
-		{
-			if (oldEntities.contains(entity))
-				entities_.insert(entity);
-			else
-				availableEntityIds_.push(entity);
-		}
+		entities_.insert(oldEntities.begin(), oldEntities.lower_bound(entityLimit));
 	}
 
 	/**
 	 * @brief Adds a new entity to the ECS.
 	 * @return The ID of the newly created entity.
-	 * @throws std::runtime_error if the maximum number of entities (MAX_ENTITIES) is reached.
+	 * @throws std::runtime_error if the entity limit of this world is reached.
 	 */
 	inline Entity addEntity()
 	{
-		if (getEntityCount() < MAX_ENTITIES)
+		// IDs reserved by an open ConcurrentBatch are neither active nor available
+		if (entityIds_.available() > 0)
 		{
-			Entity e = availableEntityIds_.front();
-			availableEntityIds_.pop();
+			Entity e = entityIds_.allocate();
 			entities_.insert(e);
+			recordStructuralChanges(1);
 			return e;
 		}
 		// throwing an exception here seems kind of drastic, but on the other hand
@@ -71,17 +99,257 @@ class ECS {
 
 	/**
 	 * @brief Removes an entity and all its associated components from the ECS.
-	 * @details The removed entity's ID is made available for reuse.
+	 * @details The removed entity's ID is made available for reuse. Children of the entity become roots, see
+	 * removeSubtree() to remove them as well.
 	 * @param e The entity to remove.
 	 */
 	inline void removeEntity(const Entity e)
 	{
 		// Remove all components associated with the entity
 		registry_.removeComponents(e);
-		// Remove entity from the set of active entities_
-		entities_.erase(e);
-		// Make the entity ID available again
-		availableEntityIds_.push(e);
+		hierarchy_.remove(e);
+		tasks_.cancel(e);
+		// Remove entity from the set of active entities_ and make its ID available again
+		if (entities_.erase(e) > 0) entityIds_.release(e);
+		recordStructuralChanges(1);
+	}
+
+	/**
+	 * @brief Removes many entities and all their associated components from the ECS at once.
+	 * @details Every component pool is compacted once at the end instead of moving a value per removed component,
+	 * which makes mass despawning considerably cheaper than calling removeEntity() in a loop. The removed entity IDs
+	 * are made available for reuse.
+	 * @param entities The entities to remove. Entities that do not exist are ignored.
+	 * @param preserveOrder Whether the remaining components keep their relative order within each pool.
+	 */
+	inline void removeEntities(std::span<const Entity> entities, const bool preserveOrder = false)
+	{
+		size_t removed = 0;
+		for (const Entity e : entities)
+		{
+			if (entities_.erase(e) > 0)
+			{
+				entityIds_.release(e);
+				removed++;
+			}
+			hierarchy_.remove(e);
+			tasks_.cancel(e);
+		}
+		registry_.removeComponents(entities, preserveOrder);
+		recordStructuralChanges(removed);
+	}
+
+	/**
+	 * @brief Starts a batch of entities and components that can be filled from many threads at once.
+	 * @details Reserves entityCount entity IDs up front and room for componentCount components of each type, so that
+	 * ConcurrentBatch::addEntity() and addComponent() only need a single atomic increment. The batch does not touch
+	 * the ECS, so producer threads may fill it while this ECS is iterated or modified. Its contents become visible with
+	 * commit(), which must be called on the thread owning the ECS once all producers finished.
+	 * @tparam Ts The component types that can be added through the batch.
+	 * @param entityCount The number of entity IDs to reserve.
+	 * @param componentCount The number of components of each type the batch can hold, defaults to entityCount.
+	 * @return The batch. It has to be committed before clear(), otherwise the reserved IDs are lost.
+	 * @throws std::runtime_error if fewer than entityCount entity IDs are available.
+	 */
+	template <typename... Ts>
+	inline ConcurrentBatch<Ts...> beginConcurrentInsert(const size_t entityCount,
+	                                                    const std::optional<size_t> componentCount = std::nullopt)
+	{
+		if (entityIds_.available() < entityCount) throw std::runtime_error("MAX NUMBER OF ENTITIES REACHED!");
+
+		std::vector<Entity> ids(entityCount);
+		for (Entity& id : ids) id = entityIds_.allocate();
+		return ConcurrentBatch<Ts...>(std::move(ids), componentCount.value_or(entityCount), generation_);
+	}
+
+	/**
+	 * @brief Adds the entities and components collected by a batch to the ECS.
+	 * @details Every pool is reserved once and filled in a single pass. Reserved entity IDs that were not handed out
+	 * are made available again, components of entities that were removed in the meantime are dropped. The batch is
+	 * empty afterwards. Must not run concurrently with any producer of the batch.
+	 * @param batch The batch returned by beginConcurrentInsert().
+	 * @throws std::logic_error if the ECS was cleared since the batch began, since its IDs may have been handed out
+	 * again. The batch is left unchanged and can only be discarded.
+	 */
+	template <typename... Ts>
+	inline void commit(ConcurrentBatch<Ts...>& batch)
+	{
+		if (batch.generation() != generation_) throw std::logic_error("The batch began before the ECS was cleared.");
+
+		const std::span<const Entity> created = batch.usedEntities();
+		entities_.insert(created.begin(), created.end());
+		for (const Entity e : batch.unusedEntities()) entityIds_.release(e);
+
+		size_t changes = created.size();
+		(
+		    [&]
+		    {
+			    auto& buffer = batch.template buffer<Ts>();
+			    const size_t needed = registry_.template size<Ts>() + buffer.size();
+			    const size_t capacity = registry_.template capacity<Ts>();
+			    if (needed > capacity) registry_.template reserve<Ts>(std::max(needed, capacity * 2));
+			    buffer.forEach(
+			        [&](auto& entry)
+			        {
+				        if (!entities_.contains(entry.entity)) return;
+				        registry_.addComponent(entry.entity, std::move(entry.component));
+				        changes++;
+			        });
+		    }(),
+		    ...);
+
+		batch.clear();
+		recordStructuralChanges(changes);
+	}
+
+	/**
+	 * @brief Creates many entities with the component values of a prefab.
+	 * @details All entity IDs are allocated first, then every pool grows once and the prefab's value is appended for
+	 * all new entities in a single pass per component type, instead of one addComponent() call per entity and type.
+	 * @param prefab The component values every new entity gets a copy of.
+	 * @param count The number of entities to create.
+	 * @return The new entities, in the order their components were appended to the pools.
+	 * @throws std::runtime_error if fewer than count entity IDs are available.
+	 */
+	template <typename... Ts>
+	inline std::vector<Entity> instantiate(const Prefab<Ts...>& prefab, const size_t count)
+	{
+		if (entityIds_.available() < count) throw std::runtime_error("MAX NUMBER OF ENTITIES REACHED!");
+
+		std::vector<Entity> created(count);
+		for (Entity& e : created)
+		{
+			e = entityIds_.allocate();
+			entities_.insert(entities_.end(), e);  // fresh IDs are mostly ascending, so the hint usually fits
+		}
+		(registry_.addComponents(std::span<const Entity>(created), prefab.template get<Ts>()), ...);
+		recordStructuralChanges(count * (sizeof...(Ts) + 1));
+		return created;
+	}
+
+	/**
+	 * @brief Creates a single entity with the component values of a prefab.
+	 * @param prefab The component values the new entity gets a copy of.
+	 * @return The new entity.
+	 * @throws std::runtime_error if the entity limit of this world is reached.
+	 */
+	template <typename... Ts>
+	inline Entity instantiate(const Prefab<Ts...>& prefab)
+	{
+		const Entity e = addEntity();
+		(addComponent(e, prefab.template get<Ts>()), ...);
+		return e;
+	}
+
+	/**
+	 * @brief Makes an entity the child of another entity.
+	 * @details The child is detached from its previous parent first and inserted in front of its new siblings.
+	 * Relationships are stored in a dedicated pool with parent, first child and sibling links, so no per-entity child
+	 * containers are needed.
+	 * @param child The entity to attach.
+	 * @param parent The new parent, or NULL_ENTITY to only detach the child.
+	 * @throws std::invalid_argument if parent is child itself or one of its descendants.
+	 */
+	inline void setParent(const Entity child, const Entity parent) { hierarchy_.setParent(child, parent); }
+
+	/**
+	 * @brief Detaches an entity from its parent, making it a root. Its own children stay attached.
+	 * @param child The entity to detach.
+	 */
+	inline void removeParent(const Entity child) { hierarchy_.detach(child); }
+
+	/**
+	 * @brief Returns the parent of an entity.
+	 * @param e The entity.
+	 * @return The parent, or NULL_ENTITY if the entity is a root.
+	 */
+	inline Entity getParent(const Entity e) const { return hierarchy_.getParent(e); }
+
+	/**
+	 * @brief Calls a function for every direct child of an entity.
+	 * @param parent The entity whose children are visited.
+	 * @param func A callable with the signature void(Entity).
+	 */
+	template <typename Func>
+	inline void forEachChild(const Entity parent, Func&& func) const
+	{
+		hierarchy_.forEachChild(parent, std::forward<Func>(func));
+	}
+
+	/**
+	 * @brief Calls a function for an entity and all of its descendants, parents before their children.
+	 * @details Entities and relationships must not be added or removed from within func.
+	 * @param root The entity to start at.
+	 * @param func A callable with the signature void(Entity).
+	 */
+	template <typename Func>
+	inline void forEachDepthFirst(const Entity root, Func&& func) const
+	{
+		hierarchy_.forEachDepthFirst(root, std::forward<Func>(func));
+	}
+
+	/**
+	 * @brief Calls a function for an entity and all of its descendants, level by level.
+	 * @details Entities and relationships must not be added or removed from within func.
+	 * @param root The entity to start at.
+	 * @param func A callable with the signature void(Entity).
+	 */
+	template <typename Func>
+	inline void forEachBreadthFirst(const Entity root, Func&& func) const
+	{
+		hierarchy_.forEachBreadthFirst(root, std::forward<Func>(func));
+	}
+
+	/**
+	 * @brief Sorts the components of type T into hierarchy order.
+	 * @details Afterwards, getEntitiesByComponent<T>() and forEach<T>() visit every parent before its children, so
+	 * e.g. transforms can be propagated in a single linear pass. Components of entities outside of any hierarchy
+	 * follow in unspecified order. The order is kept until components of type T are added or removed.
+	 * @tparam T The component type to sort.
+	 */
+	template <typename T>
+	inline void sortByHierarchy()
+	{
+		const std::vector<Entity> order = hierarchy_.depthFirstOrder();
+		registry_.template reorder<T>(order);
+	}
+
+	/**
+	 * @brief Sorts the components of type T, e.g. render components by material so that draw calls batch up.
+	 * @details The sort is stable and happens in place: an index array is sorted and every component is then moved
+	 * at most once. getEntitiesByComponent<T>() and forEach() follow the new order until T's pool changes again.
+	 * @tparam T The component type to sort.
+	 * @param compare A strict weak ordering, called as compare(const T&, const T&).
+	 */
+	template <typename T, typename Compare>
+	inline void sort(Compare&& compare)
+	{
+		registry_.template sort<T>(std::forward<Compare>(compare));
+	}
+
+	/**
+	 * @brief Orders the components of type U like the components of type T.
+	 * @details Entities with both components end up at the front of U's pool, in the order of T's pool, so a system
+	 * walking both pools in tandem (e.g. Position and Velocity) reads memory sequentially. Components of entities
+	 * without T follow in their previous relative order.
+	 * @tparam T The component type whose order is copied.
+	 * @tparam U The component type to reorder.
+	 */
+	template <typename T, typename U>
+	inline void sortAs()
+	{
+		registry_.template sortAs<T, U>();
+	}
+
+	/**
+	 * @brief Removes an entity together with all of its descendants in one batch, see removeEntities().
+	 * @param root The root of the subtree to remove.
+	 */
+	inline void removeSubtree(const Entity root)
+	{
+		std::vector<Entity> subtree;
+		hierarchy_.forEachDepthFirst(root, [&subtree](const Entity e) { subtree.push_back(e); });
+		removeEntities(subtree);
 	}
 
 	/**
@@ -119,12 +387,179 @@ class ECS {
 		return registry_.template getEntitiesByComponents<Ts...>();
 	}
 
+	/**
+	 * @brief Calls a function for every entity that has all of the specified component types.
+	 * @details Unlike getEntitiesByComponents(), this does not allocate. It walks the smallest of the requested
+	 * component pools and looks up the remaining components directly. Components of the types Ts must not be added or
+	 * removed from within func, other component types and component values may be modified freely. Const qualified
+	 * types are passed as const references and only claimed for reading, e.g. forEach<const Position, Velocity>, which
+	 * lets several threads run read-only queries over the same pool (see lock()).
+	 * @tparam Ts A variadic list of component types to query for.
+	 * @param func A callable with the signature void(Entity, Ts&...).
+	 */
+	template <typename... Ts, typename Func>
+	inline void forEach(Func&& func)
+	{
+#if EASYS_PROFILING
+		Profiler::Scope scope(*profiler_, queryName<Ts...>(), ProfileEventType::Query);
+		scope.addEntities(registry_.template forEach<Ts...>(std::forward<Func>(func)));
+#else
+		registry_.template forEach<Ts...>(std::forward<Func>(func));
+#endif
+	}
+
+	/**
+	 * @brief Claims component pools for reading or writing until the returned guard is destroyed.
+	 * @details forEach() and the component add/remove paths claim the pools they touch by themselves, lock() covers
+	 * direct access through getComponent() and friends, e.g. on an analytics thread. With EASYS_ACCESS_CHECKS, a
+	 * thread writing a pool that another thread reads or writes aborts with the name of the component type. With
+	 * EASYS_POOL_LOCKS, it waits instead. Otherwise the guard is empty and costs nothing.
+	 * @tparam Ts The component types to claim: const qualified ones for reading, all others for writing.
+	 * @return A guard that releases the pools when it is destroyed.
+	 */
+	template <typename... Ts>
+	[[nodiscard]] inline auto lock() const
+	{
+		return registry_.template lock<Ts...>();
+	}
+
+	/**
+	 * @brief Calls a function for every entity that has all of the specified static and runtime component types.
+	 * @details Like forEach(func), but additionally requires the runtime component types in ids. Ts may be empty.
+	 * @tparam Ts A variadic list of static component types to query for.
+	 * @param ids The runtime component types to query for, see registerComponent().
+	 * @param func A callable with the signature void(Entity, Ts&..., std::span<void* const>). The span holds a
+	 * pointer to each runtime component in the order of ids.
+	 */
+	template <typename... Ts, typename Func>
+	inline void forEach(std::span<const ComponentId> ids, Func&& func)
+	{
+#if EASYS_PROFILING
+		Profiler::Scope scope(*profiler_, queryName<Ts...>(), ProfileEventType::Query);
+		scope.addEntities(registry_.template forEach<Ts...>(ids, std::forward<Func>(func)));
+#else
+		registry_.template forEach<Ts...>(ids, std::forward<Func>(func));
+#endif
+	}
+
+	/**
+	 * @brief Runs a system, i.e. a callable operating on this ECS.
+	 * @details This is the entry point for per-system profiling. With EASYS_PROFILING enabled the duration of the
+	 * call, the entities visited by forEach() within it and the structural changes it made are recorded under the
+	 * given name. Otherwise this simply calls system(*this).
+	 * @param name The name of the system. Must outlive the ECS, e.g. a string literal.
+	 * @param system A callable with the signature void(ECS&).
+	 */
+	template <typename Func>
+	inline void runSystem([[maybe_unused]] const char* name, Func&& system)
+	{
+#if EASYS_PROFILING
+		Profiler::Scope scope(*profiler_, name, ProfileEventType::System);
+#endif
+		std::invoke(std::forward<Func>(system), *this);
+	}
+
+	/**
+	 * @brief Starts an asynchronous task for an entity.
+	 * @details The task is a coroutine returning Easys::Task. It runs right away until it first awaits an
+	 * AsyncOperation or nextTick(), and is resumed by runTasks() once the awaited result is available. Every entity
+	 * has at most one task, a previous one is cancelled. Removing the entity cancels its task as well.
+	 * @param e The entity the task belongs to.
+	 * @param task The task, e.g. the result of calling a coroutine function.
+	 * @throws std::logic_error if the entity's task is currently running.
+	 */
+	inline void spawnTask(const Entity e, Task task) { tasks_.spawn(e, std::move(task)); }
+
+	/**
+	 * @brief Starts an asynchronous task for every entity that has all of the specified component types.
+	 * @details Entities that already have a task are skipped, so this can be called every tick to pick up new
+	 * entities, like an asynchronous system.
+	 * @tparam Ts A variadic list of component types to query for.
+	 * @param func A callable with the signature Task(Entity).
+	 */
+	template <typename... Ts, typename Func>
+	inline void spawnTasks(Func&& func)
+	{
+		// Tasks run right away and may change the pools, so iterate over a copy of the entities
+		for (const Entity e : registry_.template getEntitiesByComponents<Ts...>())
+		{
+			if (!tasks_.contains(e)) tasks_.spawn(e, func(e));
+		}
+	}
+
+	/**
+	 * @brief Resumes the asynchronous tasks whose awaited results became available.
+	 * @details Meant to be called once per tick on the thread owning the ECS. Operations may complete on any thread,
+	 * their tasks are resumed by the next call. Tasks that finish or throw are removed, the first exception is
+	 * rethrown after all other ready tasks ran.
+	 */
+	inline void runTasks()
+	{
+#if EASYS_PROFILING
+		Profiler::Scope scope(*profiler_, "tasks", ProfileEventType::System);
+		scope.addEntities(tasks_.run());
+#else
+		tasks_.run();
+#endif
+	}
+
+	/**
+	 * @brief Cancels the asynchronous task of an entity, if it has one.
+	 * @param e The entity whose task is cancelled.
+	 */
+	inline void cancelTask(const Entity e) { tasks_.cancel(e); }
+
+	/**
+	 * @brief Checks if an entity has an unfinished asynchronous task.
+	 * @param e The entity to check.
+	 * @return True if the entity has a task, false otherwise.
+	 */
+	inline bool hasTask(const Entity e) const { return tasks_.contains(e); }
+
+	/**
+	 * @brief Returns the number of unfinished asynchronous tasks.
+	 * @return The number of tasks.
+	 */
+	inline size_t getTaskCount() const { return tasks_.size(); }
+
+	/**
+	 * @brief Marks the end of a frame (tick).
+	 * @details With EASYS_PROFILING enabled, records a frame event spanning the time since the previous call together
+	 * with the number of structural changes made in between. Otherwise this does nothing.
+	 */
+	inline void endFrame()
+	{
+#if EASYS_PROFILING
+		profiler_->endFrame();
+#endif
+	}
+
+#if EASYS_PROFILING
+	/**
+	 * @brief Returns the profiler of this ECS. Only available with EASYS_PROFILING enabled.
+	 * @return The profiler, e.g. to export the recorded events with Profiler::writeChromeTrace().
+	 */
+	inline Profiler& getProfiler() { return *profiler_; }
+
+	/**
+	 * @brief Replaces the profiler of this ECS, e.g. to record multiple ECS instances into one trace.
+	 * @param profiler The profiler to record into.
+	 */
+	inline void setProfiler(std::shared_ptr<Profiler> profiler) { profiler_ = std::move(profiler); }
+#endif
+
 	/**
 	 * @brief Returns the total number of active entities in the ECS.
 	 * @return The number of entities.
 	 */
 	inline size_t getEntityCount() const { return entities_.size(); }
 
+	/**
+	 * @brief Returns the maximum number of entities of this ECS, MAX_ENTITIES unless set at construction.
+	 * @return The entity limit.
+	 */
+	inline Entity getEntityLimit() const { return entityIds_.limit(); }
+
 	/**
 	 * @brief Adds a component of type T to an entity.
 	 * @details If the entity already has a component of type T, it will be updated with the new value.
@@ -136,6 +571,7 @@ class ECS {
 	inline void addComponent(const Entity e, T component)
 	{
 		registry_.addComponent(e, std::move(component));
+		recordStructuralChanges(1);
 	}
 
 	/**
@@ -147,6 +583,22 @@ class ECS {
 	inline void removeComponent(const Entity e)
 	{
 		registry_.template removeComponent<T>(e);
+		recordStructuralChanges(1);
+	}
+
+	/**
+	 * @brief Removes the components of type T from many entities at once.
+	 * @details The removed components are marked first and the pool is compacted in a single pass afterwards.
+	 * @tparam T The type of the component to remove.
+	 * @param entities The entities from which to remove the component. Entities without the component are ignored.
+	 * @param preserveOrder Whether the remaining components keep their relative order within the pool.
+	 */
+	template <typename T>
+	inline void removeComponents(std::span<const Entity> entities, const bool preserveOrder = false)
+	{
+		const size_t count = registry_.template size<T>();
+		registry_.template removeComponents<T>(entities, preserveOrder);
+		recordStructuralChanges(count - registry_.template size<T>());  // entities without the component do not count
 	}
 
 	/**
@@ -154,6 +606,7 @@ class ECS {
 	 * @tparam T The type of the component to retrieve.
 	 * @param e The entity whose component is to be retrieved.
 	 * @return A mutable reference to the component.
+	 * @throws KeyNotFoundException if the entity does not own a component of type T and EASYS_CHECKED is enabled.
 	 */
 	template <typename T>
 	inline T& getComponent(const Entity e)
@@ -173,6 +626,160 @@ class ECS {
 		return registry_.template getComponent<T>(e);
 	}
 
+	/**
+	 * @brief Retrieves a reference to a component of type T from an entity without checking for its presence.
+	 * @details This is the fast path for tight loops in which the presence of the component is already known, e.g.
+	 * when iterating the entities returned by getEntitiesByComponents(). Calling this for an entity that does not
+	 * own a component of type T is undefined behaviour.
+	 * @tparam T The type of the component to retrieve.
+	 * @param e The entity whose component is to be retrieved. Must own a component of type T.
+	 * @return A mutable reference to the component.
+	 */
+	template <typename T>
+	inline T& getComponentUnchecked(const Entity e)
+	{
+		return registry_.template getComponentUnchecked<T>(e);
+	}
+
+	/**
+	 * @brief Retrieves a reference to a component of type T from an entity without checking for its presence.
+	 * @tparam T The type of the component to retrieve.
+	 * @param e The entity whose component is to be retrieved. Must own a component of type T.
+	 * @return An immutable reference to the component.
+	 */
+	template <typename T>
+	inline const T& getComponentUnchecked(const Entity e) const
+	{
+		return registry_.template getComponentUnchecked<T>(e);
+	}
+
+	/**
+	 * @brief Retrieves a pointer to a component of type T from an entity, if present.
+	 * @details Combines hasComponent() and getComponent() into a single lookup and never throws.
+	 * @tparam T The type of the component to retrieve.
+	 * @param e The entity whose component is to be retrieved.
+	 * @return A pointer to the component, or nullptr if the entity does not own a component of type T.
+	 */
+	template <typename T>
+	inline T* tryGetComponent(const Entity e)
+	{
+		return registry_.template tryGetComponent<T>(e);
+	}
+
+	/**
+	 * @brief Retrieves a pointer to a component of type T from an entity, if present.
+	 * @tparam T The type of the component to retrieve.
+	 * @param e The entity whose component is to be retrieved.
+	 * @return A pointer to the immutable component, or nullptr if the entity does not own a component of type T.
+	 */
+	template <typename T>
+	inline const T* tryGetComponent(const Entity e) const
+	{
+		return registry_.template tryGetComponent<T>(e);
+	}
+
+	/**
+	 * @brief Finds the entities whose component of type T lies inside a box.
+	 * @details Only available for component types stored in a SpatialSparseSet, see ComponentStorage. Visits only the
+	 * grid cells overlapping the box instead of all components.
+	 * @tparam T The spatially indexed component type.
+	 * @param result Receives the entities, its previous contents are replaced.
+	 */
+	template <typename T>
+	inline void queryBox(const float minX, const float minY, const float maxX, const float maxY,
+	                     std::vector<Entity>& result) const
+	{
+		registry_.template getStorage<T>().grid().queryBox(minX, minY, maxX, maxY, result);
+	}
+
+	/**
+	 * @brief Finds the entities whose component of type T lies within a radius around a point.
+	 * @details Only available for component types stored in a SpatialSparseSet, see ComponentStorage.
+	 * @tparam T The spatially indexed component type.
+	 * @param result Receives the entities, its previous contents are replaced.
+	 */
+	template <typename T>
+	inline void queryRadius(const float x, const float y, const float radius, std::vector<Entity>& result) const
+	{
+		registry_.template getStorage<T>().grid().queryRadius(x, y, radius, result);
+	}
+
+	/**
+	 * @brief Updates the spatial index after a component of type T was modified in place.
+	 * @details addComponent() and removeComponent() keep the index in sync by themselves. Changes made through
+	 * getComponent() or forEach() references have to be reported with this method.
+	 * @tparam T The spatially indexed component type.
+	 * @param e The entity whose component changed.
+	 */
+	template <typename T>
+	inline void updateSpatialIndex(const Entity e)
+	{
+		registry_.template getStorage<T>().update(e);
+	}
+
+	/**
+	 * @brief Updates the spatial index for all components of type T, e.g. once per frame after a movement system.
+	 * @tparam T The spatially indexed component type.
+	 */
+	template <typename T>
+	inline void updateSpatialIndex()
+	{
+		registry_.template getStorage<T>().updateAll();
+	}
+
+	/**
+	 * @brief Changes the cell size of the spatial index for component type T.
+	 * @details Queries are fastest when the cell size is about the typical query radius. Throws
+	 * std::invalid_argument if the size is not positive.
+	 * @tparam T The spatially indexed component type.
+	 */
+	template <typename T>
+	inline void setSpatialCellSize(const float cellSize)
+	{
+		registry_.template getStorage<T>().grid().setCellSize(cellSize);
+	}
+
+	/**
+	 * @brief Publishes the values written to double buffered component types.
+	 * @details Only available for component types stored in a DoubleBufferedSparseSet, see ComponentStorage. The back
+	 * buffer, which getComponent() and forEach() access, becomes the front buffer read by getFrontComponent() and
+	 * forEachFront(). O(1) per type, no values are copied. Afterwards the back buffer holds the values from two swaps
+	 * ago, so systems should compute every value from the front buffer rather than update it in place.
+	 * @tparam Ts The double buffered component types.
+	 */
+	template <typename... Ts>
+	inline void swapBuffers()
+	{
+		(registry_.template getStorage<Ts>().swapBuffers(), ...);
+	}
+
+	/**
+	 * @brief Retrieves the value of a double buffered component as of the last swapBuffers() call.
+	 * @details Reading the front buffer from one thread while another thread writes the back buffer through
+	 * getComponent() or forEach() is safe. Structural changes (adding or removing components of type T) must not run
+	 * at the same time, and front buffer reads are not tracked by EASYS_ACCESS_CHECKS.
+	 * @tparam T The double buffered component type.
+	 * @param e The entity whose component is to be retrieved.
+	 * @return A reference to the immutable front value.
+	 */
+	template <typename T>
+	inline const T& getFrontComponent(const Entity e) const
+	{
+		return registry_.template getStorage<T>().getFront(e);
+	}
+
+	/**
+	 * @brief Calls a function with the front value of every component of a double buffered type.
+	 * @details The same concurrency rules as for getFrontComponent() apply.
+	 * @tparam T The double buffered component type.
+	 * @param func A callable with the signature void(Entity, const T&).
+	 */
+	template <typename T, typename Func>
+	inline void forEachFront(Func&& func) const
+	{
+		registry_.template getStorage<T>().forEachFront(std::forward<Func>(func));
+	}
+
 	/**
 	 * @brief Checks if an entity has a component of type T.
 	 * @tparam T The type of the component to check for.
@@ -199,13 +806,171 @@ class ECS {
 
 	inline size_t getComponentCount() const { return registry_.size(); }
 
+	/**
+	 * @brief Accesses a world-level resource, e.g. the frame time or the input state.
+	 * @details Resources are declared in the type list of the ECS as Resources<...> and exist exactly once per world.
+	 * They are stored directly, so unlike a component on a dummy entity there is no lookup at all. Resources never
+	 * move, so any number of threads may read them concurrently as long as none writes to them at the same time.
+	 * Resources are value-initialized and are not affected by clear().
+	 * @tparam T The resource type.
+	 * @return A reference to the resource.
+	 */
+	template <typename T>
+	inline T& resource()
+	{
+		return resources_.template get<T>();
+	}
+
+	/**
+	 * @brief Accesses a world-level resource.
+	 * @tparam T The resource type.
+	 * @return A reference to the immutable resource.
+	 */
+	template <typename T>
+	inline const T& resource() const
+	{
+		return resources_.template get<T>();
+	}
+
+	/**
+	 * @brief Replaces the value of a world-level resource.
+	 * @tparam T The resource type.
+	 * @param value The new value.
+	 */
+	template <typename T>
+	inline void setResource(T value)
+	{
+		resources_.template get<T>() = std::move(value);
+	}
+
+	/**
+	 * @brief Registers a component type that is only known at runtime, e.g. one defined by a script.
+	 * @details Runtime components are stored in a type-erased pool with the same sparse/dense layout as the static
+	 * ones and can be combined with static component types in forEach(). Static component types are not affected.
+	 * @param descriptor The name, size, alignment and lifetime hooks of the component type.
+	 * @return The ID used to access components of this type.
+	 * @throws std::invalid_argument if a component type with the same name is already registered.
+	 */
+	inline ComponentId registerComponent(ComponentDescriptor descriptor)
+	{
+		return registry_.registerComponent(std::move(descriptor));
+	}
+
+	/**
+	 * @brief Looks up a runtime component type by name.
+	 * @param name The name the component type was registered with.
+	 * @return The ID of the component type, or std::nullopt if no such type is registered.
+	 */
+	inline std::optional<ComponentId> findComponent(std::string_view name) const
+	{
+		return registry_.findComponent(name);
+	}
+
+	/**
+	 * @brief Returns the descriptor a runtime component type was registered with.
+	 * @param id The runtime component type.
+	 * @return The descriptor of the component type.
+	 */
+	inline const ComponentDescriptor& getDescriptor(const ComponentId id) const { return registry_.getDescriptor(id); }
+
+	/**
+	 * @brief Adds a runtime component to an entity.
+	 * @details If the entity already has a component of this type, it is replaced.
+	 * @param e The entity to which the component will be added.
+	 * @param id The runtime component type.
+	 * @param component The value to copy, or nullptr to default-construct the component.
+	 * @return A pointer to the stored component, valid until components of this type are added or removed.
+	 */
+	inline void* addComponent(const Entity e, const ComponentId id, const void* component = nullptr)
+	{
+		void* stored = registry_.addComponent(e, id, component);
+		recordStructuralChanges(1);
+		return stored;
+	}
+
+	/**
+	 * @brief Removes a runtime component from an entity.
+	 * @param e The entity from which to remove the component.
+	 * @param id The runtime component type.
+	 */
+	inline void removeComponent(const Entity e, const ComponentId id)
+	{
+		registry_.removeComponent(e, id);
+		recordStructuralChanges(1);
+	}
+
+	/**
+	 * @brief Retrieves a runtime component from an entity.
+	 * @param e The entity whose component is to be retrieved.
+	 * @param id The runtime component type.
+	 * @return A pointer to the component.
+	 * @throws KeyNotFoundException if the entity does not own the component and EASYS_CHECKED is enabled.
+	 */
+	inline void* getComponent(const Entity e, const ComponentId id) { return registry_.getComponent(e, id); }
+
+	/**
+	 * @brief Retrieves a runtime component from an entity.
+	 * @param e The entity whose component is to be retrieved.
+	 * @param id The runtime component type.
+	 * @return A pointer to the immutable component.
+	 */
+	inline const void* getComponent(const Entity e, const ComponentId id) const { return registry_.getComponent(e, id); }
+
+	/**
+	 * @brief Retrieves a runtime component from an entity, if present.
+	 * @param e The entity whose component is to be retrieved.
+	 * @param id The runtime component type.
+	 * @return A pointer to the component, or nullptr if the entity does not own it.
+	 */
+	inline void* tryGetComponent(const Entity e, const ComponentId id) { return registry_.tryGetComponent(e, id); }
+
+	/**
+	 * @brief Retrieves a runtime component from an entity, if present.
+	 * @param e The entity whose component is to be retrieved.
+	 * @param id The runtime component type.
+	 * @return A pointer to the immutable component, or nullptr if the entity does not own it.
+	 */
+	inline const void* tryGetComponent(const Entity e, const ComponentId id) const
+	{
+		return registry_.tryGetComponent(e, id);
+	}
+
+	/**
+	 * @brief Checks if an entity has a runtime component.
+	 * @param e The entity to check.
+	 * @param id The runtime component type.
+	 * @return True if the entity has the component, false otherwise.
+	 */
+	inline bool hasComponent(const Entity e, const ComponentId id) const { return registry_.hasComponent(e, id); }
+
+	/**
+	 * @brief Returns the entities that have a runtime component.
+	 * @param id The runtime component type.
+	 * @return A constant reference to a vector of entities possessing the component.
+	 */
+	inline const std::vector<Entity>& getEntitiesByComponent(const ComponentId id) const
+	{
+		return registry_.getEntitiesByComponent(id);
+	}
+
+	/**
+	 * @brief Returns the number of components of a runtime component type.
+	 * @param id The runtime component type.
+	 * @return The number of components of this type.
+	 */
+	inline size_t getComponentCount(const ComponentId id) const { return registry_.size(id); }
+
 	/**
 	 * @brief Clears all entities and components from the ECS.
-	 * @details Resets the ECS to its initial state, making all entity IDs available again.
+	 * @details Resets the ECS to its initial state, making all entity IDs available again. All tasks are cancelled,
+	 * called from within a task the running ones are destroyed once they suspend. Open concurrent batches can no longer
+	 * be committed.
 	 */
 	inline void clear()
 	{
 		registry_.clear();
+		hierarchy_.clear();
+		tasks_.clear();
 		clearEntities();
 	}
 
@@ -222,19 +987,102 @@ class ECS {
 
 	inline void clearComponents() { registry_.clear(); }
 
+	/**
+	 * @brief Preallocates storage for components of type T.
+	 * @details Reserves room for n components so that adding up to n components of type T does not reallocate the
+	 * underlying pool. Useful to size pools at load time and avoid reallocation spikes mid-frame.
+	 * @tparam T The component type to reserve storage for.
+	 * @param n The number of components to reserve storage for.
+	 */
+	template <typename T>
+	inline void reserve(const size_t n)
+	{
+		registry_.template reserve<T>(n);
+	}
+
+	/**
+	 * @brief Preallocates the entity lookup tables of all component pools.
+	 * @details After this call, adding a component to any entity with an ID below n does not grow the sparse
+	 * lookup array of that component type.
+	 * @param n The number of entity IDs to cover. Values above the entity limit are clamped.
+	 */
+	inline void reserveEntities(const size_t n)
+	{
+		registry_.reserveKeys(std::min(n, static_cast<size_t>(entityIds_.limit())));
+	}
+
+	/**
+	 * @brief Returns the number of components of type T that fit into the pool without reallocation.
+	 * @tparam T The component type to query.
+	 * @return The capacity of the component pool.
+	 */
+	template <typename T>
+	inline size_t getComponentCapacity() const
+	{
+		return registry_.template capacity<T>();
+	}
+
+	/**
+	 * @brief Releases unused memory held by component pools of the specified types.
+	 * @details Intended to be called after large amounts of entities were removed, e.g. after a level unload.
+	 * @tparam Ts A variadic list of component types. If template parameters are omitted, all component pools are
+	 * shrunk.
+	 */
+	template <typename... Ts>
+	inline void shrinkToFit()
+	{
+		registry_.template shrinkToFit<Ts...>();
+	}
+
+	inline void shrinkToFit() { registry_.shrinkToFit(); }
+
+	/**
+	 * @brief Reports the memory used by this ECS.
+	 * @details For every component type, the bytes used and reserved by the sparse lookup array, the dense entity
+	 * array and the component values are reported, together with the fill ratio of the sparse array. The memory used
+	 * to track entities is estimated from the number of active entities and free IDs. The parent/child links are
+	 * reported separately.
+	 * @return The memory statistics of all component pools, the entity bookkeeping and the hierarchy.
+	 */
+	inline MemoryStats memoryStats() const
+	{
+		// A std::set node holds three pointers, the color and the value. Only released IDs are stored.
+		constexpr size_t setNodeBytes = 3 * sizeof(void*) + sizeof(int) + sizeof(Entity);
+
+		MemoryStats stats;
+		stats.components = registry_.memoryStats();
+		stats.entities.activeEntities = entities_.size();
+		stats.entities.availableIds = entityIds_.available();
+		stats.entities.bytes = entities_.size() * setNodeBytes + entityIds_.memoryBytes();
+		stats.hierarchy = hierarchy_.memoryStats();
+		return stats;
+	}
+
    private:
-	std::queue<Entity> availableEntityIds_;
+	AsyncScheduler tasks_;  // declared first, so that copying or moving a world with pending tasks throws up front
+	EntityAllocator entityIds_;
+	uint64_t generation_ = 0;  // counts clear() calls, see commit()
+	Hierarchy hierarchy_;
 	std::set<Entity> entities_;
-	Registry<AllComponentTypes...> registry_;
+	typename ApplyTypeList<Registry, typename SplitResources<AllComponentTypes...>::Components>::type registry_;
+	[[no_unique_address]] typename ApplyTypeList<ResourceStore,
+	                                             typename SplitResources<AllComponentTypes...>::Resources>::type resources_;
+#if EASYS_PROFILING
+	std::shared_ptr<Profiler> profiler_ = std::make_shared<Profiler>();
+#endif
+
+	inline void recordStructuralChanges([[maybe_unused]] const size_t n)
+	{
+#if EASYS_PROFILING
+		profiler_->addStructuralChanges(n);
+#endif
+	}
 
 	void clearEntities()
 	{
 		entities_.clear();
-
-		std::queue<Entity> empty;
-		std::swap(availableEntityIds_, empty);
-
-		for (Entity entity = 0; entity < MAX_ENTITIES; entity++) availableEntityIds_.push(entity);
+		entityIds_.reset();
+		generation_++;  // invalidates the IDs reserved by open batches
 	}
 };
 
@@ -2,6 +2,8 @@
 
 #include <stdint.h>
 
+#include <limits>
+
 #include "config.hpp"
 
 // stdint.h needs to be included for uint32_t for Ubuntu, otherwise fails the build.
@@ -10,5 +12,7 @@ namespace Easys {
 
 using Entity = EASYS_ENTITY_TYPE;
 const Entity MAX_ENTITIES = EASYS_ENTITY_LIMIT;
+// Marks the absence of an entity, e.g. the parent of a root entity
+const Entity NULL_ENTITY = std::numeric_limits<Entity>::max();
 
 }  // namespace Easys
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "entity.hpp"
+
+namespace Easys {
+
+// Hands out entity IDs in the same order as a queue prepopulated with every ID would, without storing the IDs that
+// were never used. IDs left free by the initial set come first (ascending), then the never used IDs (ascending) and
+// finally the released IDs in the order they were released, so a released ID is reused as late as possible.
+// Creating an allocator is O(1) and its memory grows with the number of released IDs only.
+class EntityAllocator {
+   public:
+	explicit EntityAllocator(const Entity limit = MAX_ENTITIES) : limit_(limit) {}
+
+	// All IDs in used are taken, all others are available
+	EntityAllocator(const std::set<Entity>& used, const Entity limit = MAX_ENTITIES) : limit_(limit)
+	{
+		const auto end = used.lower_bound(limit);
+		if (used.begin() == end) return;
+
+		next_ = static_cast<Entity>(*std::prev(end) + 1);
+		holes_.reserve(static_cast<size_t>(next_) - std::distance(used.begin(), end));
+		for (Entity entity = next_; entity-- > 0;)
+		{
+			if (!used.contains(entity)) holes_.push_back(entity);
+		}
+	}
+
+	// Returns the next free ID. At least one ID has to be available.
+	inline Entity allocate()
+	{
+		if (!holes_.empty())
+		{
+			const Entity entity = holes_.back();
+			holes_.pop_back();
+			return entity;
+		}
+		if (next_ < limit_) return next_++;
+
+		const Entity entity = released_[releasedHead_++];
+		if (releasedHead_ == released_.size())
+		{
+			released_.clear();
+			releasedHead_ = 0;
+		}
+		return entity;
+	}
+
+	// Makes an ID available again. It must have been allocated before and not been released since.
+	inline void release(const Entity entity)
+	{
+		// Drop the IDs handed out again instead of growing, once they make up at least half of the buffer
+		if (released_.size() == released_.capacity() && releasedHead_ * 2 >= released_.size() && releasedHead_ > 0)
+		{
+			released_.erase(released_.begin(), released_.begin() + static_cast<std::ptrdiff_t>(releasedHead_));
+			releasedHead_ = 0;
+		}
+		released_.push_back(entity);
+	}
+
+	inline size_t available() const
+	{
+		return holes_.size() + static_cast<size_t>(limit_ - next_) + (released_.size() - releasedHead_);
+	}
+
+	// Forget all allocations, every ID is available again
+	inline void reset()
+	{
+		holes_.clear();
+		holes_.shrink_to_fit();
+		released_.clear();
+		released_.shrink_to_fit();
+		releasedHead_ = 0;
+		next_ = 0;
+	}
+
+	// IDs are always below the limit
+	inline Entity limit() const { return limit_; }
+
+	// Bytes used to store free IDs, excluding the fixed size of the allocator itself
+	inline size_t memoryBytes() const { return (holes_.capacity() + released_.capacity()) * sizeof(Entity); }
+
+   private:
+	Entity limit_;
+	Entity next_ = 0;               // IDs in [next_, limit_) were never used
+	std::vector<Entity> holes_;     // free IDs below the initial set's largest ID, descending
+	std::vector<Entity> released_;  // released IDs, oldest first, from releasedHead_ on. A std::deque would allocate
+	size_t releasedHead_ = 0;       // even while empty.
+};
+
+}  // namespace Easys
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include "entity.hpp"
+#include "memory_stats.hpp"
+#include "sparse_set.hpp"
+
+namespace Easys {
+
+// The links of an entity within the hierarchy. Children form a doubly linked list, so that attaching and detaching
+// is O(1) and no per-entity child vectors are needed.
+struct Relationship {
+	Entity parent = NULL_ENTITY;
+	Entity firstChild = NULL_ENTITY;
+	Entity nextSibling = NULL_ENTITY;
+	Entity prevSibling = NULL_ENTITY;
+};
+
+// Parent/child relationships between entities, stored in a dedicated pool. Only entities that have a parent or
+// children are stored. New children are inserted in front of their siblings.
+class Hierarchy {
+   public:
+	// Makes child a child of parent, detaching it from its previous parent first. A NULL_ENTITY parent detaches only.
+	// Throws std::invalid_argument if parent is child itself or one of its descendants.
+	inline void setParent(const Entity child, const Entity parent)
+	{
+		for (Entity ancestor = parent; ancestor != NULL_ENTITY; ancestor = getParent(ancestor))
+		{
+			if (ancestor == child) throw std::invalid_argument("An entity cannot be its own ancestor.");
+		}
+
+		detach(child);
+		if (parent == NULL_ENTITY) return;
+
+		// Insert both entries before taking references, an insertion may move the values
+		if (!relationships.contains(child)) relationships.set(child, Relationship{});
+		if (!relationships.contains(parent)) relationships.set(parent, Relationship{});
+
+		Relationship& childLinks = relationships.get(child);
+		Relationship& parentLinks = relationships.get(parent);
+		childLinks.parent = parent;
+		childLinks.nextSibling = parentLinks.firstChild;
+		if (parentLinks.firstChild != NULL_ENTITY) relationships.get(parentLinks.firstChild).prevSibling = child;
+		parentLinks.firstChild = child;
+	}
+
+	// Makes an entity a root again. Its children stay attached to it.
+	inline void detach(const Entity child)
+	{
+		Relationship* childLinks = relationships.tryGet(child);
+		if (!childLinks || childLinks->parent == NULL_ENTITY) return;
+
+		if (childLinks->prevSibling != NULL_ENTITY)
+			relationships.get(childLinks->prevSibling).nextSibling = childLinks->nextSibling;
+		else
+			relationships.get(childLinks->parent).firstChild = childLinks->nextSibling;
+		if (childLinks->nextSibling != NULL_ENTITY)
+			relationships.get(childLinks->nextSibling).prevSibling = childLinks->prevSibling;
+
+		const Entity parent = childLinks->parent;
+		childLinks->parent = childLinks->nextSibling = childLinks->prevSibling = NULL_ENTITY;
+		release(child);
+		release(parent);
+	}
+
+	// Removes an entity from the hierarchy. Its children become roots.
+	inline void remove(const Entity entity)
+	{
+		if (!relationships.contains(entity)) return;
+
+		detach(entity);
+		while (relationships.contains(entity))
+		{
+			const Entity child = relationships.get(entity).firstChild;
+			if (child == NULL_ENTITY) break;
+			detach(child);
+		}
+	}
+
+	inline Entity getParent(const Entity entity) const
+	{
+		const Relationship* entityLinks = relationships.tryGet(entity);
+		return entityLinks ? entityLinks->parent : NULL_ENTITY;
+	}
+
+	inline Entity getFirstChild(const Entity entity) const
+	{
+		const Relationship* entityLinks = relationships.tryGet(entity);
+		return entityLinks ? entityLinks->firstChild : NULL_ENTITY;
+	}
+
+	inline Entity getNextSibling(const Entity entity) const
+	{
+		const Relationship* entityLinks = relationships.tryGet(entity);
+		return entityLinks ? entityLinks->nextSibling : NULL_ENTITY;
+	}
+
+	// Calls func(child) for the direct children of parent
+	template <typename Func>
+	inline void forEachChild(const Entity parent, Func&& func) const
+	{
+		for (Entity child = getFirstChild(parent); child != NULL_ENTITY;)
+		{
+			const Entity next = getNextSibling(child);
+			func(child);
+			child = next;
+		}
+	}
+
+	// Calls func(entity) for root and all of its descendants, parents before their children. Follows the links, so no
+	// stack is needed. The hierarchy must not be modified from within func.
+	template <typename Func>
+	inline void forEachDepthFirst(const Entity root, Func&& func) const
+	{
+		Entity entity = root;
+		while (entity != NULL_ENTITY)
+		{
+			func(entity);
+
+			// Descend if possible, otherwise move to the next sibling of the closest ancestor below root that has one
+			Entity next = getFirstChild(entity);
+			while (next == NULL_ENTITY && entity != root)
+			{
+				next = getNextSibling(entity);
+				if (next == NULL_ENTITY) entity = getParent(entity);
+			}
+			entity = next;
+		}
+	}
+
+	// Calls func(entity) for root and all of its descendants, level by level. The hierarchy must not be modified from
+	// within func.
+	template <typename Func>
+	inline void forEachBreadthFirst(const Entity root, Func&& func) const
+	{
+		std::deque<Entity> queue = {root};
+		while (!queue.empty())
+		{
+			const Entity entity = queue.front();
+			queue.pop_front();
+			func(entity);
+			forEachChild(entity, [&queue](const Entity child) { queue.push_back(child); });
+		}
+	}
+
+	// All entities that have children, each followed by its descendants in depth-first order
+	inline std::vector<Entity> depthFirstOrder() const
+	{
+		std::vector<Entity> order;
+		order.reserve(relationships.size());
+		for (const Entity entity : relationships.getKeys())
+		{
+			if (relationships.get(entity).parent != NULL_ENTITY) continue;
+			forEachDepthFirst(entity, [&order](const Entity e) { order.push_back(e); });
+		}
+		return order;
+	}
+
+	// Number of entities that have a parent or children
+	inline size_t size() const { return relationships.size(); }
+
+	inline void clear() { relationships.clear(); }
+
+	inline PoolMemoryStats memoryStats() const { return relationships.memoryStats(); }
+
+   private:
+	SparseSet<Entity, Relationship> relationships;
+
+	// Drop the entry of an entity that has neither a parent nor children anymore
+	inline void release(const Entity entity)
+	{
+		const Relationship* entityLinks = relationships.tryGet(entity);
+		if (entityLinks && entityLinks->parent == NULL_ENTITY && entityLinks->firstChild == NULL_ENTITY)
+		{
+			relationships.remove(entity);
+		}
+	}
+};
+
+}  // namespace Easys
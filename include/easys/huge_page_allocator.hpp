@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Easys {
+
+// How large allocations are backed by huge pages
+enum class HugePages {
+	Transparent,  // madvise(MADV_HUGEPAGE), the kernel uses 2 MiB pages wherever it can
+	Explicit      // mmap(MAP_HUGETLB) from the reserved huge page pool, Transparent if no huge pages are reserved
+};
+
+// Where the pages of large allocations live on machines with several NUMA nodes
+enum class NumaPlacement {
+	FirstTouch,  // The kernel default, a page lives on the node of the thread that writes it first
+	Local,       // Prefer the node of the allocating thread, e.g. the worker that fills and processes the pool
+	Interleave   // Spread the pages over all nodes, for pools processed by threads on every node
+};
+
+// A std::allocator replacement for the values of very large pools, e.g. ten million transforms, where TLB misses on
+// 4 KiB pages become a noticeable part of every random access. Allocations of at least 2 MiB are mapped directly,
+// aligned to 2 MiB and backed by huge pages, so one TLB entry covers 512 times as much memory. Smaller allocations,
+// and all allocations on platforms other than Linux, go through std::allocator. The huge page and NUMA requests are
+// hints: if the kernel refuses them (no reserved huge pages, a single node, a sandbox) the memory is still usable.
+template <typename T, HugePages Pages = HugePages::Transparent, NumaPlacement Placement = NumaPlacement::FirstTouch>
+class HugePageAllocator {
+   public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind {
+		using other = HugePageAllocator<U, Pages, Placement>;
+	};
+
+	static constexpr size_t hugePageSize = size_t{2} << 20;
+
+	HugePageAllocator() = default;
+
+	template <typename U>
+	HugePageAllocator(const HugePageAllocator<U, Pages, Placement>&) noexcept
+	{
+	}
+
+	inline T* allocate(const size_t n)
+	{
+		if (n > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+		if (!isMapped(n)) return std::allocator<T>().allocate(n);
+		return static_cast<T*>(map(mappedSize(n)));
+	}
+
+	inline void deallocate(T* const pointer, const size_t n) noexcept
+	{
+		if (!isMapped(n))
+		{
+			std::allocator<T>().deallocate(pointer, n);
+			return;
+		}
+#if defined(__linux__)
+		munmap(pointer, mappedSize(n));
+#endif
+	}
+
+	friend bool operator==(const HugePageAllocator&, const HugePageAllocator&) { return true; }
+
+   private:
+	// Decided by the size alone, so that deallocate() takes the same path as the allocate() call before
+	static constexpr bool isMapped([[maybe_unused]] const size_t n)
+	{
+#if defined(__linux__)
+		return n * sizeof(T) >= hugePageSize;
+#else
+		return false;
+#endif
+	}
+
+	static constexpr size_t mappedSize(const size_t n)
+	{
+		return (n * sizeof(T) + hugePageSize - 1) & ~(hugePageSize - 1);
+	}
+
+#if defined(__linux__)
+	static inline void* map(const size_t size)
+	{
+		void* memory = nullptr;
+#ifdef MAP_HUGETLB
+		if constexpr (Pages == HugePages::Explicit)
+		{
+			memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (memory == MAP_FAILED) memory = nullptr;
+		}
+#endif
+		if (!memory) memory = mapTransparent(size);
+		place(memory, size);
+		return memory;
+	}
+
+	// Maps one huge page more than needed and trims both ends, so that the range starts on a huge page boundary
+	static inline void* mapTransparent(const size_t size)
+	{
+		void* raw = mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw == MAP_FAILED) throw std::bad_alloc();
+
+		const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+		const uintptr_t aligned = (start + hugePageSize - 1) & ~(hugePageSize - 1);
+		if (aligned > start) munmap(raw, aligned - start);
+		const uintptr_t end = aligned + size;
+		const uintptr_t rawEnd = start + size + hugePageSize;
+		if (rawEnd > end) munmap(reinterpret_cast<void*>(end), rawEnd - end);
+
+		void* memory = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+		madvise(memory, size, MADV_HUGEPAGE);
+#endif
+		return memory;
+	}
+
+	// Sets the NUMA policy of a fresh mapping before any page of it is touched. Uses the mbind system call directly,
+	// so libnuma is not needed. Supports the first 64 nodes.
+	static inline void place([[maybe_unused]] void* memory, [[maybe_unused]] const size_t size)
+	{
+#ifdef SYS_mbind
+		constexpr int preferred = 1;   // MPOL_PREFERRED
+		constexpr int interleave = 3;  // MPOL_INTERLEAVE
+		constexpr unsigned long maxNode = sizeof(unsigned long) * 8 + 1;
+
+		if constexpr (Placement == NumaPlacement::Local)
+		{
+			unsigned cpu = 0;
+			unsigned node = 0;
+			if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= sizeof(unsigned long) * 8) return;
+			const unsigned long mask = 1ul << node;
+			syscall(SYS_mbind, memory, size, preferred, &mask, maxNode, 0u);
+		} else if constexpr (Placement == NumaPlacement::Interleave)
+		{
+			const unsigned long mask = ~0ul;  // the kernel drops nodes without memory or outside the cpuset
+			syscall(SYS_mbind, memory, size, interleave, &mask, maxNode, 0u);
+		}
+#endif
+	}
+#else
+	static inline void* map(size_t) { return nullptr; }
+#endif
+};
+
+}  // namespace Easys
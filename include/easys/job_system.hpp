@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Easys {
+
+// A fixed pool of worker threads that can be shared by many ECS instances ("worlds"), e.g. one world per match on a
+// game server. An ECS itself is not thread-safe, but independent worlds can be updated in parallel as long as every
+// world is only touched by one job at a time. The thread that calls wait() runs jobs as well, so a JobSystem without
+// workers simply runs all jobs on the calling thread.
+class JobSystem {
+   public:
+	// By default one worker per hardware thread besides the calling thread
+	explicit JobSystem(size_t workers = std::max(1u, std::thread::hardware_concurrency()) - 1)
+	{
+		workers_.reserve(workers);
+		for (size_t i = 0; i < workers; i++) workers_.emplace_back([this] { work(); });
+	}
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Finishes all submitted jobs before the workers are stopped
+	~JobSystem()
+	{
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		workAvailable_.notify_all();
+		for (auto& worker : workers_) worker.join();
+	}
+
+	inline void submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard lock(mutex_);
+			jobs_.push_back(std::move(job));
+			pending_++;
+		}
+		workAvailable_.notify_one();
+		allDone_.notify_all();  // a waiting thread helps as well
+	}
+
+	// Runs jobs until all submitted jobs have finished. If a job threw, the first exception is rethrown here.
+	inline void wait()
+	{
+		std::unique_lock lock(mutex_);
+		while (pending_ > 0)
+		{
+			if (!runJob(lock)) allDone_.wait(lock, [this] { return pending_ == 0 || !jobs_.empty(); });
+		}
+
+		if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+	}
+
+	// Calls func(item) for every item as a separate job and waits for all of them, e.g. to update a list of worlds
+	template <typename Range, typename Func>
+	inline void forEach(Range& range, Func&& func)
+	{
+		for (auto& item : range)
+		{
+			submit([&item, &func] { func(item); });
+		}
+		wait();
+	}
+
+	inline size_t workerCount() const { return workers_.size(); }
+
+   private:
+	std::mutex mutex_;
+	std::condition_variable workAvailable_;
+	std::condition_variable allDone_;
+	std::deque<std::function<void()>> jobs_;
+	size_t pending_ = 0;  // submitted jobs that have not finished yet
+	bool stopping_ = false;
+	std::exception_ptr error_;
+	std::vector<std::thread> workers_;
+
+	// Runs the next queued job with the lock released. Returns false if there was none.
+	inline bool runJob(std::unique_lock<std::mutex>& lock)
+	{
+		if (jobs_.empty()) return false;
+
+		std::function<void()> job = std::move(jobs_.front());
+		jobs_.pop_front();
+		lock.unlock();
+
+		std::exception_ptr error;
+		try
+		{
+			job();
+		} catch (...)
+		{
+			error = std::current_exception();
+		}
+
+		lock.lock();
+		if (error && !error_) error_ = error;
+		if (--pending_ == 0) allDone_.notify_all();
+		return true;
+	}
+
+	inline void work()
+	{
+		std::unique_lock lock(mutex_);
+		while (true)
+		{
+			workAvailable_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+			if (!runJob(lock) && stopping_) return;
+		}
+	}
+};
+
+}  // namespace Easys
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Easys {
+
+// Memory footprint of a single component pool in bytes. "Used" counts the bytes occupied by live elements, "reserved"
+// the bytes allocated by the container. Heap memory owned by the component values themselves (e.g. the buffer of a
+// std::string member) is not included.
+struct PoolMemoryStats {
+	size_t sparseUsed = 0;  // the part of the sparse array that is indexed by keys
+	size_t sparseReserved = 0;
+	size_t denseUsed = 0;
+	size_t denseReserved = 0;
+	size_t valuesUsed = 0;
+	size_t valuesReserved = 0;
+	size_t indexBytes = 0;         // estimated size of storage specific lookup structures, e.g. a spatial grid
+	double sparseFillRatio = 0.0;  // elements per sparse slot, low values mean a mostly empty lookup table
+
+	size_t used() const { return sparseUsed + denseUsed + valuesUsed + indexBytes; }
+	size_t reserved() const { return sparseReserved + denseReserved + valuesReserved + indexBytes; }
+};
+
+struct ComponentMemoryStats {
+	const char* name;  // readable name of the component type
+	size_t count;      // number of components
+	PoolMemoryStats pool;
+};
+
+// Estimated memory used to keep track of entities, i.e. the set of active entities and the free IDs
+struct EntityMemoryStats {
+	size_t activeEntities = 0;
+	size_t availableIds = 0;
+	size_t bytes = 0;
+};
+
+struct MemoryStats {
+	std::vector<ComponentMemoryStats> components;
+	EntityMemoryStats entities;
+	PoolMemoryStats hierarchy;  // the parent/child links set through ECS::setParent()
+
+	size_t componentBytesUsed() const
+	{
+		size_t total = 0;
+		for (const auto& component : components) total += component.pool.used();
+		return total;
+	}
+
+	size_t componentBytesReserved() const
+	{
+		size_t total = 0;
+		for (const auto& component : components) total += component.pool.reserved();
+		return total;
+	}
+
+	size_t totalBytes() const { return componentBytesReserved() + entities.bytes + hierarchy.reserved(); }
+};
+
+}  // namespace Easys
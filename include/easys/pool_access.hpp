@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "config.hpp"
+
+namespace Easys {
+
+// What happens when two threads access the same component pool in conflicting ways, i.e. one of them writes
+enum class AccessMode {
+	None,   // Not tracked, access is free
+	Check,  // Report the conflict, see setAccessConflictHandler()
+	Lock    // Wait until the pool is free, a reader/writer lock per pool
+};
+
+inline constexpr AccessMode defaultAccessMode = EASYS_POOL_LOCKS      ? AccessMode::Lock
+                                                : EASYS_ACCESS_CHECKS ? AccessMode::Check
+                                                                      : AccessMode::None;
+
+using AccessConflictHandler = void (*)(const std::string& message);
+
+// The default handler prints the message and aborts
+inline AccessConflictHandler& accessConflictHandler()
+{
+	static AccessConflictHandler handler = [](const std::string& message)
+	{
+		std::fprintf(stderr, "%s\n", message.c_str());
+		std::abort();
+	};
+	return handler;
+}
+
+// Replaces the function called on conflicting access in AccessMode::Check, e.g. to throw in tests. The handler must
+// not return normally. Returns the previous handler, so that it can be restored.
+inline AccessConflictHandler setAccessConflictHandler(const AccessConflictHandler handler)
+{
+	return std::exchange(accessConflictHandler(), handler);
+}
+
+// The readers and the writer of a single component pool. Any number of threads may read at the same time, a writer
+// needs the pool for itself. The writing thread may read and write its pool again, so nesting iterations on one
+// thread is no conflict. A thread that only reads a pool must not start writing it before its reads ended.
+template <AccessMode Mode>
+class PoolAccess {
+   public:
+	PoolAccess() = default;
+
+	// A copied pool is not accessed by anyone yet
+	PoolAccess(const PoolAccess&) {}
+	PoolAccess& operator=(const PoolAccess&) { return *this; }
+
+	inline void beginRead(const char* (*name)())
+	{
+		if (ownsWrite()) return;
+
+		int32_t state = state_.load(std::memory_order_acquire);
+		while (true)
+		{
+			if (state >= 0)
+			{
+				if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) return;
+				continue;
+			}
+			state = conflict(state, "read", name);
+		}
+	}
+
+	inline void endRead()
+	{
+		if (ownsWrite()) return;
+		if (state_.fetch_sub(1, std::memory_order_release) == 1 && Mode == AccessMode::Lock) state_.notify_all();
+	}
+
+	inline void beginWrite(const char* (*name)())
+	{
+		if (ownsWrite())
+		{
+			writeDepth++;
+			return;
+		}
+
+		int32_t state = 0;
+		while (!state_.compare_exchange_weak(state, writing, std::memory_order_acquire))
+		{
+			if (state == 0) continue;  // spurious failure
+			state = conflict(state, "write", name);
+			state = 0;
+		}
+		writer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+		writeDepth = 1;
+	}
+
+	inline void endWrite()
+	{
+		if (--writeDepth > 0) return;
+		writer.store(std::thread::id(), std::memory_order_relaxed);
+		state_.store(0, std::memory_order_release);
+		if constexpr (Mode == AccessMode::Lock) state_.notify_all();
+	}
+
+   private:
+	static constexpr int32_t writing = -1;
+
+	std::atomic<int32_t> state_ = 0;  // number of readers, or writing
+	std::atomic<std::thread::id> writer;
+	uint32_t writeDepth = 0;  // only touched by the writer
+
+	// Only the writer itself stores its own ID, so a relaxed load is enough to recognize it
+	inline bool ownsWrite() const { return writer.load(std::memory_order_relaxed) == std::this_thread::get_id(); }
+
+	// Waits for the state to change (Lock) or reports the conflict (Check). Returns the new state.
+	inline int32_t conflict(const int32_t state, const char* access, const char* (*name)())
+	{
+		if constexpr (Mode == AccessMode::Lock)
+		{
+			state_.wait(state, std::memory_order_relaxed);
+			return state_.load(std::memory_order_acquire);
+		} else
+		{
+			accessConflictHandler()(std::string("Easys: conflicting access to component ") + name() + ": " + access
+			                        + (state == writing ? " while another thread writes it"
+			                                            : " while " + std::to_string(state) + " thread(s) read it"));
+			return state_.load(std::memory_order_acquire);
+		}
+	}
+};
+
+// Nothing to track, takes no space next to a pool
+template <>
+class PoolAccess<AccessMode::None> {
+};
+
+// One pool claimed by an AccessGuard
+template <AccessMode Mode>
+struct PoolClaim {
+	size_t order;  // pools are always claimed in the same order, so that two guards cannot deadlock
+	PoolAccess<Mode>* access;
+	const char* (*name)();
+	bool write;
+};
+
+// Holds read or write access to a set of pools for its lifetime. Duplicate pools are claimed once, for writing if any
+// of the claims writes.
+template <AccessMode Mode, size_t N>
+class AccessGuard {
+   public:
+	explicit AccessGuard(std::array<PoolClaim<Mode>, N> claims) : claims_(claims)
+	{
+		std::sort(claims_.begin(), claims_.end(), [](const auto& a, const auto& b) { return a.order < b.order; });
+		try
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				if (i + 1 < N && claims_[i + 1].access == claims_[i].access)
+				{
+					claims_[i + 1].write = claims_[i + 1].write || claims_[i].write;
+					claims_[i].access = nullptr;
+				} else
+				{
+					claims_[i].write ? claims_[i].access->beginWrite(claims_[i].name)
+					                 : claims_[i].access->beginRead(claims_[i].name);
+				}
+				claimed = i + 1;
+			}
+		} catch (...)
+		{
+			release();  // a conflict handler may throw, e.g. in tests
+			throw;
+		}
+	}
+
+	AccessGuard(const AccessGuard&) = delete;
+	AccessGuard& operator=(const AccessGuard&) = delete;
+
+	~AccessGuard() { release(); }
+
+   private:
+	std::array<PoolClaim<Mode>, N> claims_;
+	size_t claimed = 0;  // claims before this index have begun
+
+	inline void release()
+	{
+		for (size_t i = claimed; i-- > 0;)
+		{
+			if (!claims_[i].access) continue;
+			claims_[i].write ? claims_[i].access->endWrite() : claims_[i].access->endRead();
+		}
+		claimed = 0;
+	}
+};
+
+// Without tracking there is nothing to hold
+template <size_t N>
+class AccessGuard<AccessMode::None, N> {
+};
+
+}  // namespace Easys
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+#include "type_index.hpp"
+
+namespace Easys {
+
+// A template for entities: one value of every component type in Ts, e.g.
+//
+//   Easys::Prefab goblin(Health{30}, Speed{4.0f}, Sprite{"goblin.png"});
+//   std::vector<Easys::Entity> wave = ecs.instantiate(goblin, 500);
+//
+// ECS::instantiate() copies the values to every new entity, appending them to each pool in one pass per type. The
+// set of types is fixed at compile time, the values can be changed at runtime through get(), e.g. to scale the
+// health of a wave with the difficulty.
+template <typename... Ts>
+class Prefab {
+   public:
+	static_assert(sizeof...(Ts) > 0, "A prefab needs at least one component type.");
+
+	Prefab() = default;
+	explicit Prefab(Ts... components) : components(std::move(components)...) {}
+
+	template <typename T>
+	inline T& get()
+	{
+		static_assert(containsType<T, Ts...>, "The prefab does not contain this component type.");
+		return std::get<typeIndex<T, Ts...>>(components);
+	}
+
+	template <typename T>
+	inline const T& get() const
+	{
+		static_assert(containsType<T, Ts...>, "The prefab does not contain this component type.");
+		return std::get<typeIndex<T, Ts...>>(components);
+	}
+
+   private:
+	std::tuple<Ts...> components;
+};
+
+}  // namespace Easys
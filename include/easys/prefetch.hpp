@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#include "config.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace Easys {
+
+inline constexpr size_t prefetchDistance = EASYS_PREFETCH_DISTANCE;
+
+// Hints the CPU to load the cache line holding address for reading. Never faults, so it may point anywhere.
+inline void prefetch([[maybe_unused]] const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#endif
+}
+
+}  // namespace Easys
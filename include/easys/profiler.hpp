@@ -0,0 +1,246 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "type_name.hpp"
+
+namespace Easys {
+
+enum class ProfileEventType : uint8_t {
+	System,  // a call to ECS::runSystem()
+	Query,   // an iteration over entities, e.g. ECS::forEach()
+	Frame    // the time between two calls to ECS::endFrame()
+};
+
+struct ProfileEvent {
+	const char* name = nullptr;  // must outlive the profiler, e.g. a string literal
+	ProfileEventType type = ProfileEventType::System;
+	uint32_t threadId = 0;
+	uint64_t start = 0;              // nanoseconds since the profiler was created
+	uint64_t duration = 0;           // nanoseconds
+	uint64_t entities = 0;           // number of entities visited
+	uint64_t structuralChanges = 0;  // entity/component additions and removals
+};
+
+// Records profile events into a fixed size ring buffer. Recording is lock-free and may happen from multiple threads,
+// once the buffer is full the oldest events are overwritten. Every slot is guarded by a sequence number, so readers
+// skip events that are overwritten while being read. The events themselves are copied through relaxed atomic words,
+// so a torn read is detected without a data race.
+class Profiler {
+   public:
+	using Clock = std::chrono::steady_clock;
+
+	// Measures the lifetime of the scope and records it as a single event. Queries that run within a system scope on
+	// the same thread add their visited entities to the system.
+	class Scope {
+	   public:
+		Scope(Profiler& profiler, const char* name, ProfileEventType type)
+		    : profiler_(profiler), parent_(current()), changesAtStart_(profiler.structuralChanges())
+		{
+			event_.name = name;
+			event_.type = type;
+			event_.start = profiler.now();
+			current() = this;
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		~Scope()
+		{
+			event_.duration = profiler_.now() - event_.start;
+			event_.structuralChanges = profiler_.structuralChanges() - changesAtStart_;
+			if (parent_) parent_->event_.entities += event_.entities;
+			current() = parent_;
+			profiler_.record(event_);
+		}
+
+		void addEntities(uint64_t n) { event_.entities += n; }
+
+	   private:
+		Profiler& profiler_;
+		Scope* parent_;
+		uint64_t changesAtStart_;
+		ProfileEvent event_;
+
+		static Scope*& current()
+		{
+			thread_local Scope* scope = nullptr;
+			return scope;
+		}
+	};
+
+	explicit Profiler(size_t capacity = 1 << 14) : origin_(Clock::now())
+	{
+		size_t size = 1;
+		while (size < capacity) size <<= 1;
+		slots_ = std::make_unique<Slot[]>(size);
+		mask_ = size - 1;
+	}
+
+	inline uint64_t now() const
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin_).count());
+	}
+
+	inline void record(ProfileEvent event)
+	{
+		event.threadId = currentThreadId();
+
+		const uint64_t index = writeIndex_.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = slots_[index & mask_];
+
+		// Odd sequence: write in progress. Even sequence: holds the event with the matching index.
+		slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		storeEvent(slot, event);
+		slot.sequence.store(2 * index + 2, std::memory_order_release);
+	}
+
+	inline void addStructuralChanges(uint64_t n) { structuralChanges_.fetch_add(n, std::memory_order_relaxed); }
+
+	inline uint64_t structuralChanges() const { return structuralChanges_.load(std::memory_order_relaxed); }
+
+	// Records a Frame event spanning the time since the previous call. Should be called from a single thread.
+	inline void endFrame()
+	{
+		const uint64_t end = now();
+		const uint64_t changes = structuralChanges();
+
+		ProfileEvent event;
+		event.name = "frame";
+		event.type = ProfileEventType::Frame;
+		event.start = frameStart_;
+		event.duration = end - frameStart_;
+		event.structuralChanges = changes - frameChanges_;
+		record(event);
+
+		frameStart_ = end;
+		frameChanges_ = changes;
+	}
+
+	// Number of events recorded in total, including those that were already overwritten
+	inline uint64_t recordedEvents() const { return writeIndex_.load(std::memory_order_acquire); }
+
+	inline size_t capacity() const { return mask_ + 1; }
+
+	// A snapshot of the events still held by the buffer, oldest first
+	inline std::vector<ProfileEvent> events() const
+	{
+		const uint64_t end = writeIndex_.load(std::memory_order_acquire);
+		const uint64_t begin = end > capacity() ? end - capacity() : 0;
+
+		std::vector<ProfileEvent> result;
+		result.reserve(end - begin);
+		for (uint64_t index = begin; index < end; index++)
+		{
+			const Slot& slot = slots_[index & mask_];
+			const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+			if (before != 2 * index + 2) continue;
+
+			const ProfileEvent event = loadEvent(slot);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) == before) result.push_back(event);
+		}
+		return result;
+	}
+
+	// Writes the buffered events in the Chrome trace event format, viewable in chrome://tracing or Perfetto
+	inline void writeChromeTrace(std::ostream& os) const
+	{
+		os << "{\"traceEvents\": [";
+		bool first = true;
+		for (const ProfileEvent& event : events())
+		{
+			os << (first ? "\n" : ",\n") << "  {\"name\": \"" << (event.name ? event.name : "") << "\", \"cat\": \""
+			   << categoryName(event.type) << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << event.threadId
+			   << ", \"ts\": " << static_cast<double>(event.start) / 1000.0
+			   << ", \"dur\": " << static_cast<double>(event.duration) / 1000.0
+			   << ", \"args\": {\"entities\": " << event.entities
+			   << ", \"structuralChanges\": " << event.structuralChanges << "}}";
+			first = false;
+		}
+		os << "\n], \"displayTimeUnit\": \"ms\"}\n";
+	}
+
+   private:
+	static_assert(std::is_trivially_copyable_v<ProfileEvent>);
+	static constexpr size_t eventWords = (sizeof(ProfileEvent) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	struct Slot {
+		std::atomic<uint64_t> sequence{0};
+		std::array<std::atomic<uint64_t>, eventWords> event{};
+	};
+
+	std::unique_ptr<Slot[]> slots_;
+	size_t mask_ = 0;
+	std::atomic<uint64_t> writeIndex_{0};
+	std::atomic<uint64_t> structuralChanges_{0};
+	Clock::time_point origin_;
+	uint64_t frameStart_ = 0;
+	uint64_t frameChanges_ = 0;
+
+	static inline void storeEvent(Slot& slot, const ProfileEvent& event)
+	{
+		uint64_t words[eventWords] = {};
+		std::memcpy(words, &event, sizeof(ProfileEvent));
+		for (size_t i = 0; i < eventWords; i++) slot.event[i].store(words[i], std::memory_order_relaxed);
+	}
+
+	static inline ProfileEvent loadEvent(const Slot& slot)
+	{
+		uint64_t words[eventWords];
+		for (size_t i = 0; i < eventWords; i++) words[i] = slot.event[i].load(std::memory_order_relaxed);
+		ProfileEvent event;
+		std::memcpy(&event, words, sizeof(ProfileEvent));
+		return event;
+	}
+
+	static const char* categoryName(ProfileEventType type)
+	{
+		switch (type)
+		{
+			case ProfileEventType::System:
+				return "system";
+			case ProfileEventType::Query:
+				return "query";
+			case ProfileEventType::Frame:
+				return "frame";
+		}
+		return "";
+	}
+
+	static uint32_t currentThreadId()
+	{
+		thread_local const uint32_t id =
+		    static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xFFFFFFFF);
+		return id;
+	}
+};
+
+// A readable name for a list of types, e.g. "forEach<Position, Velocity>". The returned string lives forever.
+template <typename... Ts>
+inline const char* queryName()
+{
+	static const std::string name = []
+	{
+		std::string result = "forEach<";
+		bool first = true;
+		((result += (first ? "" : ", ") + std::string(typeName<Ts>()), first = false), ...);
+		return result + ">";
+	}();
+	return name.c_str();
+}
+
+}  // namespace Easys
@@ -1,32 +1,57 @@
 #pragma once
 
 #include <any>
+#include <array>
+#include <deque>
+#include <optional>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "dynamic_sparse_set.hpp"
 #include "entity.hpp"
+#include "memory_stats.hpp"
+#include "pool_access.hpp"
 #include "sparse_set.hpp"
+#include "storage.hpp"
+#include "type_index.hpp"
+#include "type_name.hpp"
 
 namespace Easys {
 
 template <typename... AllComponentTypes>
 class Registry {
    private:
-	mutable std::tuple<SparseSet<Entity, AllComponentTypes>...> componentSets;
+	mutable ComponentPools<Entity, AllComponentTypes...> componentSets;
+	// Indexed by ComponentId, a deque keeps descriptors in place. Created by the first registration, since an empty
+	// std::deque already allocates.
+	std::optional<std::deque<DynamicSparseSet<Entity>>> dynamicSets;
 
    public:
 	template <typename ComponentType>
 	inline void addComponent(const Entity entity, const ComponentType& component)
 	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
 		auto& componentSet = getComponentSet<ComponentType>();
 		componentSet.set(entity, std::move(component));
 	}
 
+	template <typename ComponentType>
+	inline void addComponents(std::span<const Entity> entities, const ComponentType& component)
+	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
+		getComponentSet<ComponentType>().set(entities, component);
+	}
+
 	template <typename ComponentType>
 	inline void removeComponent(const Entity entity)
 	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
 		auto& componentSet = getComponentSet<ComponentType>();
 		componentSet.remove(entity);
 	}
@@ -38,6 +63,7 @@ class Registry {
 		    {
 			    removeComponent<Component>(entity);
 		    });
+		forEachDynamicSet([entity](auto& dynamicSet) { dynamicSet.remove(entity); });
 	}
 
 	template <typename... ComponentTypes>
@@ -50,11 +76,49 @@ class Registry {
 		    });
 	}
 
+	template <typename ComponentType>
+	inline void removeComponents(std::span<const Entity> entities, const bool preserveOrder = false)
+	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
+		getComponentSet<ComponentType>().remove(entities, preserveOrder);
+	}
+
+	inline void removeComponents(std::span<const Entity> entities, const bool preserveOrder = false)
+	{
+		// The entities may be a view into one of our pools (e.g. from getEntitiesByComponent()), which changes while
+		// we remove from it. In that case we work on a copy.
+		bool isPoolView = false;
+		forEachComponentType<AllComponentTypes...>(
+		    [&]<typename Component>()
+		    {
+			    isPoolView = isPoolView || getComponentSet<Component>().aliases(entities);
+		    });
+		forEachDynamicSet([&](const auto& dynamicSet) { isPoolView = isPoolView || dynamicSet.aliases(entities); });
+
+		if (isPoolView)
+		{
+			const std::vector<Entity> copy(entities.begin(), entities.end());
+			removeComponents(std::span<const Entity>(copy), preserveOrder);
+			return;
+		}
+
+		forEachComponentType<AllComponentTypes...>(
+		    [&]<typename Component>()
+		    {
+			    removeComponents<Component>(entities, preserveOrder);
+		    });
+		forEachDynamicSet(
+		    [entities](auto& dynamicSet)
+		    {
+			    for (const Entity entity : entities) dynamicSet.remove(entity);
+		    });
+	}
+
 	template <typename ComponentType>
 	inline ComponentType& getComponent(const Entity entity)
 	{
 		auto& componentSet = getComponentSet<ComponentType>();
-		// could be optimized with direct access. get() calls contains() internally
+		// get() checks for presence unless EASYS_CHECKED is disabled, see getComponentUnchecked() for direct access
 		return componentSet.get(entity);
 	}
 
@@ -62,10 +126,33 @@ class Registry {
 	inline const ComponentType& getComponent(const Entity entity) const
 	{
 		const auto& componentSet = getComponentSet<ComponentType>();
-		// could be optimized with direct access. get() calls contains() internally
 		return componentSet.get(entity);
 	}
 
+	template <typename ComponentType>
+	inline ComponentType& getComponentUnchecked(const Entity entity)
+	{
+		return getComponentSet<ComponentType>()[entity];
+	}
+
+	template <typename ComponentType>
+	inline const ComponentType& getComponentUnchecked(const Entity entity) const
+	{
+		return getComponentSet<ComponentType>()[entity];
+	}
+
+	template <typename ComponentType>
+	inline ComponentType* tryGetComponent(const Entity entity)
+	{
+		return getComponentSet<ComponentType>().tryGet(entity);
+	}
+
+	template <typename ComponentType>
+	inline const ComponentType* tryGetComponent(const Entity entity) const
+	{
+		return getComponentSet<ComponentType>().tryGet(entity);
+	}
+
 	template <typename ComponentType>
 	inline bool hasComponent(const Entity entity) const
 	{
@@ -81,6 +168,7 @@ class Registry {
 	template <typename... ComponentTypes>
 	inline std::vector<Entity> getEntitiesByComponents() const
 	{
+		[[maybe_unused]] const auto guard = lock<const ComponentTypes...>();
 		std::vector<Entity> entities;
 		bool isFirstComponentType = true;
 
@@ -114,6 +202,143 @@ class Registry {
 		return entities;
 	}
 
+	// Calls func(entity, components...) for every entity that owns all of the given component types. Walks the
+	// smallest of the pools and looks up the others directly. Returns the number of visited entities. Const qualified
+	// types are passed as const references and only read, e.g. forEach<const Position, Velocity>.
+	template <typename... ComponentTypes, typename Func>
+	inline size_t forEach(Func&& func)
+	{
+		static_assert(sizeof...(ComponentTypes) > 0, "forEach requires at least one component type.");
+		[[maybe_unused]] const auto guard = lock<ComponentTypes...>();
+
+		const std::vector<Entity>* smallest = nullptr;
+		forEachComponentType<std::remove_const_t<ComponentTypes>...>(
+		    [this, &smallest]<typename T>()
+		    {
+			    const std::vector<Entity>& keys = getComponentSet<T>().getKeys();
+			    if (!smallest || keys.size() < smallest->size()) smallest = &keys;
+		    });
+
+		const std::vector<Entity>& keys = *smallest;
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			if constexpr (prefetchDistance > 0) prefetchAhead<ComponentTypes...>(keys, i);
+
+			const Entity entity = keys[i];
+			if ((poolOf<ComponentTypes>().contains(entity) && ...))
+			{
+				func(entity, poolOf<ComponentTypes>()[entity]...);
+			}
+		}
+		return keys.size();
+	}
+
+	// Like forEach() above, but additionally requires the given runtime component types. Calls
+	// func(entity, components..., dynamicComponents), where dynamicComponents is a std::span<void* const> holding a
+	// pointer to each dynamic component in the order of ids.
+	template <typename... ComponentTypes, typename Func>
+	inline size_t forEach(std::span<const ComponentId> ids, Func&& func)
+	{
+		[[maybe_unused]] const auto guard = lock<ComponentTypes...>();
+		std::vector<DynamicSparseSet<Entity>*> sets;
+		sets.reserve(ids.size());
+		for (const ComponentId id : ids) sets.push_back(&getDynamicSet(id));
+
+		const std::vector<Entity>* smallest = nullptr;
+		forEachComponentType<std::remove_const_t<ComponentTypes>...>(
+		    [this, &smallest]<typename T>()
+		    {
+			    const std::vector<Entity>& keys = getComponentSet<T>().getKeys();
+			    if (!smallest || keys.size() < smallest->size()) smallest = &keys;
+		    });
+		for (const auto* set : sets)
+		{
+			if (!smallest || set->size() < smallest->size()) smallest = &set->getKeys();
+		}
+		if (!smallest) return 0;
+
+		std::vector<void*> dynamicComponents(sets.size());
+		const std::vector<Entity>& keys = *smallest;
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			if constexpr (prefetchDistance > 0) prefetchAhead<ComponentTypes...>(keys, i);
+
+			const Entity entity = keys[i];
+			if (!(poolOf<ComponentTypes>().contains(entity) && ...)) continue;
+			if (!std::all_of(sets.begin(), sets.end(), [entity](const auto* set) { return set->contains(entity); }))
+			{
+				continue;
+			}
+
+			for (size_t j = 0; j < sets.size(); j++) dynamicComponents[j] = (*sets[j])[entity];
+			func(entity, poolOf<ComponentTypes>()[entity]..., std::span<void* const>(dynamicComponents));
+		}
+		return smallest->size();
+	}
+
+	// Register a component type that is only known at runtime. Its pool lives as long as the registry.
+	inline ComponentId registerComponent(ComponentDescriptor descriptor)
+	{
+		if (findComponent(descriptor.name))
+		{
+			throw std::invalid_argument("A component named " + descriptor.name + " is already registered.");
+		}
+		if (!dynamicSets) dynamicSets.emplace();
+		dynamicSets->emplace_back(std::move(descriptor));
+		return static_cast<ComponentId>(dynamicSets->size() - 1);
+	}
+
+	inline std::optional<ComponentId> findComponent(std::string_view name) const
+	{
+		if (!dynamicSets) return std::nullopt;
+		for (size_t i = 0; i < dynamicSets->size(); i++)
+		{
+			if ((*dynamicSets)[i].descriptor().name == name) return static_cast<ComponentId>(i);
+		}
+		return std::nullopt;
+	}
+
+	inline const ComponentDescriptor& getDescriptor(const ComponentId id) const
+	{
+		return getDynamicSet(id).descriptor();
+	}
+
+	inline void* addComponent(const Entity entity, const ComponentId id, const void* component = nullptr)
+	{
+		return getDynamicSet(id).set(entity, component);
+	}
+
+	inline void removeComponent(const Entity entity, const ComponentId id) { getDynamicSet(id).remove(entity); }
+
+	inline void* getComponent(const Entity entity, const ComponentId id) { return getDynamicSet(id).get(entity); }
+
+	inline const void* getComponent(const Entity entity, const ComponentId id) const
+	{
+		return getDynamicSet(id).get(entity);
+	}
+
+	inline void* tryGetComponent(const Entity entity, const ComponentId id)
+	{
+		return getDynamicSet(id).tryGet(entity);
+	}
+
+	inline const void* tryGetComponent(const Entity entity, const ComponentId id) const
+	{
+		return getDynamicSet(id).tryGet(entity);
+	}
+
+	inline bool hasComponent(const Entity entity, const ComponentId id) const
+	{
+		return getDynamicSet(id).contains(entity);
+	}
+
+	inline const std::vector<Entity>& getEntitiesByComponent(const ComponentId id) const
+	{
+		return getDynamicSet(id).getKeys();
+	}
+
+	inline size_t size(const ComponentId id) const { return getDynamicSet(id).size(); }
+
 	inline size_t size() const
 	{
 		size_t totalSize = 0;
@@ -123,6 +348,7 @@ class Registry {
 		    {
 			    totalSize += getComponentSet<T>().size();
 		    });
+		forEachDynamicSet([&totalSize](const auto& dynamicSet) { totalSize += dynamicSet.size(); });
 
 		return totalSize;
 	}
@@ -141,13 +367,16 @@ class Registry {
 		return totalSize;
 	}
 
+	// Removes all components. Runtime component types stay registered.
 	inline void clear()
 	{
 		forEachComponentType<AllComponentTypes...>(
 		    [this]<typename T>()
 		    {
+			    [[maybe_unused]] const auto guard = lock<T>();
 			    getComponentSet<T>().clear();
 		    });
+		forEachDynamicSet([](auto& dynamicSet) { dynamicSet.clear(); });
 	}
 
 	template <typename... ComponentTypes>
@@ -156,39 +385,213 @@ class Registry {
 		forEachComponentType<ComponentTypes...>(
 		    [this]<typename T>()
 		    {
+			    [[maybe_unused]] const auto guard = lock<T>();
 			    getComponentSet<T>().clear();
 		    });
 	}
 
+	template <typename ComponentType>
+	inline void reserve(const size_t n)
+	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
+		getComponentSet<ComponentType>().reserve(n);
+	}
+
+	inline void reserveKeys(const size_t n)
+	{
+		forEachComponentType<AllComponentTypes...>(
+		    [this, n]<typename T>()
+		    {
+			    [[maybe_unused]] const auto guard = lock<T>();
+			    getComponentSet<T>().reserveKeys(n);
+		    });
+		forEachDynamicSet([n](auto& dynamicSet) { dynamicSet.reserveKeys(n); });
+	}
+
+	// Claims the pools of the given component types until the returned guard is destroyed: const qualified types for
+	// reading, all others for writing. Pools are claimed in a fixed order, so guards on different threads cannot
+	// deadlock. Without EASYS_ACCESS_CHECKS and EASYS_POOL_LOCKS the guard is empty.
+	template <typename... ComponentTypes>
+	inline auto lock() const
+	{
+		static_assert((isRegisteredComponent<std::remove_const_t<ComponentTypes>> && ...),
+		              "Tried to access an unregistered component type in ECS.");
+		if constexpr (defaultAccessMode == AccessMode::None)
+		{
+			return AccessGuard<AccessMode::None, sizeof...(ComponentTypes)>{};
+		} else
+		{
+			return AccessGuard<defaultAccessMode, sizeof...(ComponentTypes)>(
+			    std::array<PoolClaim<defaultAccessMode>, sizeof...(ComponentTypes)>{
+			        PoolClaim<defaultAccessMode>{typeIndex<std::remove_const_t<ComponentTypes>, AllComponentTypes...>,
+			                                     &componentSets.template access<std::remove_const_t<ComponentTypes>>(),
+			                                     &typeName<std::remove_const_t<ComponentTypes>>,
+			                                     !std::is_const_v<ComponentTypes>}...});
+		}
+	}
+
+	// The pool of a component type, for features of specific storage types (see ComponentStorage)
+	template <typename ComponentType>
+	inline ComponentStorageType<Entity, ComponentType>& getStorage()
+	{
+		return getComponentSet<ComponentType>();
+	}
+
+	template <typename ComponentType>
+	inline const ComponentStorageType<Entity, ComponentType>& getStorage() const
+	{
+		return getComponentSet<ComponentType>();
+	}
+
+	template <typename ComponentType>
+	inline void reorder(std::span<const Entity> order)
+	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
+		getComponentSet<ComponentType>().reorder(order);
+	}
+
+	template <typename ComponentType, typename Compare>
+	inline void sort(Compare&& compare)
+	{
+		[[maybe_unused]] const auto guard = lock<ComponentType>();
+		getComponentSet<ComponentType>().sort(std::forward<Compare>(compare));
+	}
+
+	// Orders the pool of ComponentType like the pool of OrderType, entities without OrderType follow at the end
+	template <typename OrderType, typename ComponentType>
+	inline void sortAs()
+	{
+		if constexpr (!std::is_same_v<OrderType, ComponentType>)
+		{
+			[[maybe_unused]] const auto guard = lock<const OrderType, ComponentType>();
+			getComponentSet<ComponentType>().reorder(getComponentSet<OrderType>().getKeys());
+		}
+	}
+
+	template <typename ComponentType>
+	inline size_t capacity() const
+	{
+		return getComponentSet<ComponentType>().capacity();
+	}
+
+	inline void shrinkToFit()
+	{
+		forEachComponentType<AllComponentTypes...>(
+		    [this]<typename T>()
+		    {
+			    [[maybe_unused]] const auto guard = lock<T>();
+			    getComponentSet<T>().shrinkToFit();
+		    });
+		forEachDynamicSet([](auto& dynamicSet) { dynamicSet.shrinkToFit(); });
+	}
+
+	template <typename... ComponentTypes>
+	inline void shrinkToFit()
+	{
+		forEachComponentType<ComponentTypes...>(
+		    [this]<typename T>()
+		    {
+			    [[maybe_unused]] const auto guard = lock<T>();
+			    getComponentSet<T>().shrinkToFit();
+		    });
+	}
+
+	inline std::vector<ComponentMemoryStats> memoryStats() const
+	{
+		std::vector<ComponentMemoryStats> stats;
+		stats.reserve(sizeof...(AllComponentTypes) + (dynamicSets ? dynamicSets->size() : 0));
+
+		forEachComponentType<AllComponentTypes...>(
+		    [this, &stats]<typename T>()
+		    {
+			    const auto& componentSet = getComponentSet<T>();
+			    stats.push_back({typeName<T>(), componentSet.size(), componentSet.memoryStats()});
+		    });
+		forEachDynamicSet(
+		    [&stats](const auto& dynamicSet)
+		    {
+			    stats.push_back({dynamicSet.descriptor().name.c_str(), dynamicSet.size(), dynamicSet.memoryStats()});
+		    });
+
+		return stats;
+	}
+
    private:
 	template <typename T>
-	static constexpr bool isRegisteredComponent = (std::is_same_v<T, AllComponentTypes> || ...);
+	static constexpr bool isRegisteredComponent = containsType<T, AllComponentTypes...>;
 
 	template <typename... ComponentTypes, typename Func>
 	inline void forEachComponentType(Func&& f) const
 	{
-		// MSVC does not support multiple expressions in a fold statement so we use this small helper
-		auto staticAssertAndCall = [&f]<typename T>()
-		{
-			static_assert(isRegisteredComponent<T>, "Tried to access an unregistered component type in ECS.");
-			f.template operator()<T>();
-		};
+		// A single assertion and fold, a helper lambda per type would double the instantiations for long type lists
+		static_assert((isRegisteredComponent<ComponentTypes> && ...),
+		              "Tried to access an unregistered component type in ECS.");
+		(f.template operator()<ComponentTypes>(), ...);
+	}
+
+	inline DynamicSparseSet<Entity>& getDynamicSet(const ComponentId id)
+	{
+		if (!dynamicSets) throw std::out_of_range("No runtime component types are registered.");
+		return dynamicSets->at(static_cast<size_t>(id));
+	}
+
+	inline const DynamicSparseSet<Entity>& getDynamicSet(const ComponentId id) const
+	{
+		return const_cast<Registry*>(this)->getDynamicSet(id);
+	}
+
+	template <typename Func>
+	inline void forEachDynamicSet(Func&& func)
+	{
+		if (!dynamicSets) return;
+		for (auto& dynamicSet : *dynamicSets) func(dynamicSet);
+	}
 
-		(staticAssertAndCall.template operator()<ComponentTypes>(), ...);
+	template <typename Func>
+	inline void forEachDynamicSet(Func&& func) const
+	{
+		if (!dynamicSets) return;
+		for (const auto& dynamicSet : *dynamicSets) func(dynamicSet);
 	}
 
 	template <typename ComponentType>
-	inline SparseSet<Entity, ComponentType>& getComponentSet()
+	inline ComponentStorageType<Entity, ComponentType>& getComponentSet()
 	{
 		static_assert(isRegisteredComponent<ComponentType>, "Tried to access an unregistered component type.");
-		return std::get<SparseSet<Entity, ComponentType>>(componentSets);
+		return componentSets.template get<ComponentType>();
 	}
 
 	template <typename ComponentType>
-	inline const SparseSet<Entity, ComponentType>& getComponentSet() const
+	inline const ComponentStorageType<Entity, ComponentType>& getComponentSet() const
 	{
 		static_assert(isRegisteredComponent<ComponentType>, "Tried to access an unregistered component type.");
-		return std::get<SparseSet<Entity, ComponentType>>(componentSets);
+		return componentSets.template get<ComponentType>();
+	}
+
+	// The pool of a possibly const qualified component type, read-only for const ones
+	template <typename ComponentType>
+	inline auto& poolOf()
+	{
+		if constexpr (std::is_const_v<ComponentType>)
+			return std::as_const(getComponentSet<std::remove_const_t<ComponentType>>());
+		else
+			return getComponentSet<ComponentType>();
+	}
+
+	// Looking up a component is two dependent loads, the sparse slot and then the value. While walking keys, prefetch
+	// the sparse slots prefetchDistance entities ahead and the values half as far, once their slots have arrived. The
+	// driving pool is walked in order, so it is left to the hardware prefetcher.
+	template <typename... ComponentTypes>
+	inline void prefetchAhead(const std::vector<Entity>& keys, const size_t i) const
+	{
+		forEachComponentType<std::remove_const_t<ComponentTypes>...>(
+		    [this, &keys, i]<typename T>()
+		    {
+			    const auto& pool = getComponentSet<T>();
+			    if (&pool.getKeys() == &keys) return;
+			    if (i + prefetchDistance < keys.size()) pool.prefetchKey(keys[i + prefetchDistance]);
+			    if (i + prefetchDistance / 2 < keys.size()) pool.prefetchValue(keys[i + prefetchDistance / 2]);
+		    });
 	}
 };
 
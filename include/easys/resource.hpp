@@ -0,0 +1,95 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "type_index.hpp"
+
+namespace Easys {
+
+// Declares world-level resources (time, input, configuration, ...) in the type list of an ECS, e.g.
+// ECS<Position, Velocity, Resources<Time, Input>>. Every resource exists exactly once per world and is stored
+// directly instead of in a pool, see ECS::resource().
+template <typename... Ts>
+struct Resources {
+};
+
+template <typename T>
+inline constexpr bool isResources = false;
+
+template <typename... Ts>
+inline constexpr bool isResources<Resources<Ts...>> = true;
+
+template <typename... Ts>
+struct TypeList {
+};
+
+// Only used in unevaluated contexts to concatenate type lists with a fold expression
+template <typename... As, typename... Bs>
+TypeList<As..., Bs...> operator+(TypeList<As...>, TypeList<Bs...>);
+
+template <typename T>
+struct ResourceTypesOf {
+	using type = TypeList<>;
+};
+
+template <typename... Ts>
+struct ResourceTypesOf<Resources<Ts...>> {
+	using type = TypeList<Ts...>;
+};
+
+// Splits the type list of an ECS into component types and resource types. Lists without Resources<...> are passed
+// through as they are, so the common case does not pay for the split at compile time.
+template <bool HasResources, typename... Ts>
+struct SplitTypeList {
+	using Components = TypeList<Ts...>;
+	using Resources = TypeList<>;
+};
+
+template <typename... Ts>
+struct SplitTypeList<true, Ts...> {
+	using Components = decltype((TypeList<>{} + ... + std::conditional_t<isResources<Ts>, TypeList<>, TypeList<Ts>>{}));
+	using Resources = decltype((TypeList<>{} + ... + typename ResourceTypesOf<Ts>::type{}));
+};
+
+template <typename... Ts>
+using SplitResources = SplitTypeList<(isResources<Ts> || ...), Ts...>;
+
+// Instantiates Template with the types of a TypeList
+template <template <typename...> class Template, typename List>
+struct ApplyTypeList;
+
+template <template <typename...> class Template, typename... Ts>
+struct ApplyTypeList<Template, TypeList<Ts...>> {
+	using type = Template<Ts...>;
+};
+
+// Holds one value-initialized instance of every resource type. The position of a resource is a constexpr index, so
+// accessing one compiles down to a member access. Values never move, which makes concurrent reads safe as long as no
+// thread writes to the same resource at the same time.
+template <typename... Ts>
+class ResourceStore {
+   public:
+	template <typename T>
+	static constexpr bool contains = containsType<T, Ts...>;
+
+	template <typename T>
+	inline T& get()
+	{
+		static_assert(contains<T>, "Tried to access an unregistered resource type.");
+		return std::get<typeIndex<T, Ts...>>(values);
+	}
+
+	template <typename T>
+	inline const T& get() const
+	{
+		static_assert(contains<T>, "Tried to access an unregistered resource type.");
+		return std::get<typeIndex<T, Ts...>>(values);
+	}
+
+   private:
+	std::tuple<Ts...> values;
+};
+
+}  // namespace Easys
@@ -3,11 +3,20 @@
 #include <algorithm>
 #include <cassert>
 #include <concepts>
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <numeric>
+#include <span>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "config.hpp"
+#include "memory_stats.hpp"
+#include "prefetch.hpp"
+
 namespace Easys {
 
 class KeyNotFoundException : public std::exception {
@@ -25,12 +34,139 @@ class KeyNotFoundException : public std::exception {
 template <typename T>
 concept UnsignedIntegral = std::is_integral_v<T> && std::is_unsigned_v<T>;
 
-template <UnsignedIntegral Key, typename Value>
+// Determines what happens to the dense arrays when a single key is removed.
+enum class DeletionPolicy {
+	SwapAndPop,  // Move the last value into the hole. O(1), but changes the order of the values.
+	InPlace      // Leave a tombstone and compact later. O(1) amortized and keeps the order of the values.
+};
+
+// ValueContainer is the container used for the values. It defaults to std::vector, but any container providing the
+// subset of the std::vector interface used below can be plugged in (e.g. ChunkedVector for stable addresses).
+// Index is the type of the positions stored in the sparse array. A type narrower than Key shrinks the sparse array,
+// which has a slot for every key, but limits the set to std::numeric_limits<Index>::max() values.
+//
+// The removal, reorder and sort operations optionally take further containers that are indexed like the values, e.g.
+// the second buffer of a double buffered pool, and move their elements along with the values. This is only supported
+// for DeletionPolicy::SwapAndPop, since InPlace compacts later without them.
+template <UnsignedIntegral Key,
+          typename Value,
+          typename ValueContainer = std::vector<Value>,
+          DeletionPolicy Policy = DeletionPolicy::SwapAndPop,
+          UnsignedIntegral Index = Key>
 class SparseSet {
    private:
-	std::vector<Key> sparse;    // Large, indexed by keys
-	std::vector<Key> dense;     // Compact, stores keys
-	std::vector<Value> values;  // Parallel to dense, stores values
+	static constexpr Key tombstone = std::numeric_limits<Key>::max();
+	static constexpr Index empty = std::numeric_limits<Index>::max();  // sparse slot of a key that is not set
+
+	// mutable, so that deferred compaction (DeletionPolicy::InPlace) can run from const accessors like getKeys()
+	mutable std::vector<Index> sparse;  // Large, indexed by keys
+	mutable std::vector<Key> dense;   // Compact, stores keys
+	mutable ValueContainer values;    // Parallel to dense, stores values
+	mutable size_t tombstones = 0;    // Number of removed slots in dense that are waiting for compaction
+
+	template <typename... Parallel>
+	static constexpr bool supportsParallel = sizeof...(Parallel) == 0 || Policy == DeletionPolicy::SwapAndPop;
+
+	// Remove all tombstones from dense and values in a single pass. With preserveOrder the relative order of the
+	// remaining values is kept, otherwise holes are filled from the back which moves fewer values.
+	template <typename... Parallel>
+	inline void compactTombstones(const bool preserveOrder, Parallel&... parallel) const
+	{
+		size_t end = dense.size();
+		if (preserveOrder)
+		{
+			size_t write = 0;
+			for (size_t read = 0; read < end; read++)
+			{
+				if (dense[read] == tombstone) continue;
+				if (write != read)
+				{
+					dense[write] = dense[read];
+					values[write] = std::move(values[read]);
+					((parallel[write] = std::move(parallel[read])), ...);
+					sparse[dense[write]] = static_cast<Index>(write);
+				}
+				write++;
+			}
+			end = write;
+		} else
+		{
+			size_t i = 0;
+			while (i < end)
+			{
+				if (dense[i] != tombstone)
+				{
+					i++;
+					continue;
+				}
+
+				end--;
+				if (i != end && dense[end] != tombstone)
+				{
+					dense[i] = dense[end];
+					values[i] = std::move(values[end]);
+					((parallel[i] = std::move(parallel[end])), ...);
+					sparse[dense[i]] = static_cast<Index>(i);
+					i++;
+				}
+			}
+		}
+
+		while (values.size() > end) values.pop_back();
+		(parallel.erase(parallel.begin() + static_cast<std::ptrdiff_t>(end), parallel.end()), ...);
+		dense.resize(end);
+		tombstones = 0;
+	}
+
+	// Mark the slot of a key as removed without touching the rest of the dense arrays
+	inline void markRemoved(const Key key)
+	{
+		dense[sparse[key]] = tombstone;
+		sparse[key] = empty;
+		tombstones++;
+	}
+
+	// Rearrange dense and values so that index i holds what was at source[i] before. source is used as scratch space.
+	template <typename... Parallel>
+	inline void permute(std::vector<size_t>& source, Parallel&... parallel)
+	{
+		for (size_t start = 0; start < source.size(); start++)
+		{
+			if (source[start] == start) continue;
+
+			Value value = std::move(values[start]);
+			std::tuple<typename Parallel::value_type...> parallelValues(std::move(parallel[start])...);
+			const Key key = dense[start];
+			size_t current = start;
+			while (source[current] != start)
+			{
+				const size_t next = source[current];
+				values[current] = std::move(values[next]);
+				((parallel[current] = std::move(parallel[next])), ...);
+				dense[current] = dense[next];
+				sparse[dense[current]] = static_cast<Index>(current);
+				source[current] = current;
+				current = next;
+			}
+			values[current] = std::move(value);
+			std::apply([&](auto&... moved) { ((parallel[current] = std::move(moved)), ...); }, parallelValues);
+			dense[current] = key;
+			sparse[key] = static_cast<Index>(current);
+			source[current] = current;
+		}
+	}
+
+	// An Index narrower than Key can only address so many values, its largest value marks keys that are not set
+	inline void checkPopulation() const
+	{
+		if constexpr (sizeof(Index) < sizeof(Key))
+		{
+			if (values.size() >= static_cast<size_t>(empty))
+			{
+				throw std::length_error("The number of values exceeds the index type of the set.");
+			}
+		}
+	}
 
    public:
 	// Ensure the sparse array can accommodate the given key
@@ -43,20 +179,19 @@ class SparseSet {
 
 		if (key >= sparse.size())
 		{
-			sparse.resize(key * 2 + 1, std::numeric_limits<Key>::max());
+			sparse.resize(key * 2 + 1, empty);
 		}
 	}
 
-	// Associate a value with a key
-
 	// Associate a value with a key
 	inline void set(const Key key, const Value& value)
 	{
 		accommodate(key);
 
-		if (sparse[key] == std::numeric_limits<Key>::max())
-		{  // max Key to indicate not set
-			sparse[key] = static_cast<Key>(values.size());
+		if (sparse[key] == empty)
+		{
+			checkPopulation();
+			sparse[key] = static_cast<Index>(values.size());
 			dense.push_back(key);
 			values.push_back(value);
 		} else
@@ -70,9 +205,10 @@ class SparseSet {
 	{
 		accommodate(key);
 
-		if (sparse[key] == std::numeric_limits<Key>::max())
+		if (sparse[key] == empty)
 		{
-			sparse[key] = static_cast<Key>(values.size());
+			checkPopulation();
+			sparse[key] = static_cast<Index>(values.size());
 			dense.push_back(key);
 			values.push_back(std::move(value));
 		} else
@@ -81,37 +217,110 @@ class SparseSet {
 		}
 	}
 
+	// Associate the same value with many keys at once, e.g. when spawning a batch of entities from a prefab. The sparse
+	// array is grown and the dense arrays are reserved once up front, then every new key is appended in a single pass.
+	inline void set(std::span<const Key> keys, const Value& value)
+	{
+		if (keys.empty()) return;
+		accommodate(*std::max_element(keys.begin(), keys.end()));
+
+		const size_t needed = dense.size() + keys.size();
+		if (needed > values.capacity()) reserve(std::max(needed, values.capacity() * 2));
+
+		for (const Key key : keys)
+		{
+			if (sparse[key] == empty)
+			{
+				checkPopulation();
+				sparse[key] = static_cast<Index>(values.size());
+				dense.push_back(key);
+				values.push_back(value);
+			} else
+			{
+				values[sparse[key]] = value;
+			}
+		}
+	}
+
 	// Retrieve a value by key
 	inline const Value& get(const Key key) const
 	{
+#if EASYS_CHECKED
 		if (!contains(key))
 		{
 			throw KeyNotFoundException(std::to_string(key));
 		}
+#else
+		assert(contains(key));
+#endif
 		return values[sparse[key]];
 	}
 
 	// Retrieve a value by key
 	inline Value& get(const Key key)
 	{
+#if EASYS_CHECKED
 		if (!contains(key))
 		{
 			throw KeyNotFoundException(std::to_string(key));
 		}
+#else
+		assert(contains(key));
+#endif
 		return values[sparse[key]];
 	}
 
+	// Retrieve a value by key, or nullptr if the key is not set
+	inline const Value* tryGet(const Key key) const { return contains(key) ? &values[sparse[key]] : nullptr; }
+	inline Value* tryGet(const Key key) { return contains(key) ? &values[sparse[key]] : nullptr; }
+
+	// Retrieve a value by key without any checks. The key has to be set.
 	inline const Value& operator[](const Key key) const { return values[sparse[key]]; }
 	inline Value& operator[](const Key key) { return values[sparse[key]]; }
 
+	// The position of a key's value in getValues(), e.g. to index a parallel container. The key has to be set.
+	inline size_t indexOf(const Key key) const
+	{
+		compact();
+		return sparse[key];
+	}
+
+	// Prefetch the sparse slot of a key, the first of the two dependent loads of a lookup
+	inline void prefetchKey(const Key key) const
+	{
+		if (key < sparse.size()) prefetch(&sparse[key]);
+	}
+
+	// Prefetch the value of a key. Reads the sparse slot, so that should have been prefetched a while before.
+	inline void prefetchValue(const Key key) const
+	{
+		if (key >= sparse.size()) return;
+		const Index index = sparse[key];
+		if (index < values.size()) prefetch(&values[index]);
+	}
+
 	// Remove a value associated with a key
-	inline void remove(const Key key)
+	template <typename... Parallel>
+	inline void remove(const Key key, Parallel&... parallel)
 	{
-		if (contains(key))
+		static_assert(supportsParallel<Parallel...>, "Parallel containers require DeletionPolicy::SwapAndPop.");
+		if constexpr (Policy == DeletionPolicy::InPlace)
+		{
+			if (contains(key))
+			{
+				markRemoved(key);
+				// Compacting once half of the slots are dead keeps removal O(1) amortized
+				if (tombstones * 2 >= dense.size()) compact();
+			}
+		} else if (contains(key))
 		{
 			// Move the last value to the removed spot to keep dense packed
-			Key indexOfRemoved = sparse[key];
-			values[indexOfRemoved] = values.back();
+			const Index indexOfRemoved = sparse[key];
+			if (indexOfRemoved != dense.size() - 1)
+			{
+				values[indexOfRemoved] = std::move(values.back());
+				((parallel[indexOfRemoved] = std::move(parallel.back())), ...);
+			}
 			dense[indexOfRemoved] = dense.back();
 
 			// Update the sparse array for the moved key
@@ -120,16 +329,90 @@ class SparseSet {
 			// Shrink the dense array and values
 			dense.pop_back();
 			values.pop_back();
+			(parallel.pop_back(), ...);
 
 			// Mark the key as not set
-			sparse[key] = std::numeric_limits<Key>::max();
+			sparse[key] = empty;
 		}
 	}
 
+	// Remove the values of many keys at once. Removed slots are marked with a tombstone first and the set is compacted
+	// in a single pass afterwards. With preserveOrder (always the case for DeletionPolicy::InPlace) the relative order
+	// of the remaining values is kept, otherwise holes are filled from the back which moves fewer values.
+	template <typename... Parallel>
+	inline void remove(std::span<const Key> keys, const bool preserveOrder = false, Parallel&... parallel)
+	{
+		static_assert(supportsParallel<Parallel...>, "Parallel containers require DeletionPolicy::SwapAndPop.");
+		// The keys may be a view into our own dense array (e.g. from getKeys()), which we are about to modify.
+		if (aliases(keys))
+		{
+			const std::vector<Key> copy(keys.begin(), keys.end());
+			remove(std::span<const Key>(copy), preserveOrder, parallel...);
+			return;
+		}
+
+		for (const Key key : keys)
+		{
+			if (contains(key)) markRemoved(key);
+		}
+
+		if (tombstones > 0) compactTombstones(preserveOrder || Policy == DeletionPolicy::InPlace, parallel...);
+	}
+
+	// Apply pending removals. Only DeletionPolicy::InPlace defers removals, for SwapAndPop this is a no-op.
+	// Note that the accessors exposing the dense arrays call this implicitly, so they are not safe to call
+	// concurrently with each other on an InPlace set with pending removals.
+	inline void compact() const
+	{
+		if constexpr (Policy == DeletionPolicy::InPlace)
+		{
+			if (tombstones > 0) compactTombstones(true);
+		}
+	}
+
+	// Move the values of the given keys to the front, in the given order. Keys that are not set or appear more than
+	// once are skipped, the values of keys not in order follow in their previous relative order.
+	template <typename... Parallel>
+	inline void reorder(std::span<const Key> order, Parallel&... parallel)
+	{
+		static_assert(supportsParallel<Parallel...>, "Parallel containers require DeletionPolicy::SwapAndPop.");
+		compact();
+		std::vector<size_t> source;  // new index -> old index
+		source.reserve(dense.size());
+		std::vector<bool> placed(dense.size(), false);
+		for (const Key key : order)
+		{
+			if (!contains(key) || placed[sparse[key]]) continue;
+			placed[sparse[key]] = true;
+			source.push_back(sparse[key]);
+		}
+		for (size_t i = 0; i < dense.size(); i++)
+		{
+			if (!placed[i]) source.push_back(i);
+		}
+		permute(source, parallel...);
+	}
+
+	// Sort the values with compare(const Value&, const Value&), e.g. render components by material. The sort is
+	// stable. Only an index array is sorted, the values are then moved into place along the cycles of the resulting
+	// permutation, so every value is moved at most once (plus one temporary per cycle).
+	template <typename Compare, typename... Parallel>
+	inline void sort(Compare compare, Parallel&... parallel)
+	{
+		static_assert(supportsParallel<Parallel...>, "Parallel containers require DeletionPolicy::SwapAndPop.");
+		compact();
+		std::vector<size_t> source(dense.size());
+		std::iota(source.begin(), source.end(), size_t{0});
+		std::stable_sort(source.begin(), source.end(),
+		                 [&](const size_t a, const size_t b) { return compare(values[a], values[b]); });
+		permute(source, parallel...);
+	}
+
 	// Iterate over all values
 	template <typename Func>
 	inline void forEach(Func f)
 	{
+		compact();
 		for (size_t i = 0; i < values.size(); ++i)
 		{
 			f(dense[i], values[i]);
@@ -138,16 +421,36 @@ class SparseSet {
 
 	constexpr bool contains(const Key key) const
 	{
-		return key < sparse.size() && sparse[key] != std::numeric_limits<Key>::max();
+		return key < sparse.size() && sparse[key] != empty;
 	}
 
-	constexpr size_t size() const { return dense.size(); }
+	// Whether the given keys are a view into the keys of this set
+	inline bool aliases(std::span<const Key> keys) const
+	{
+		if (keys.empty() || dense.empty()) return false;
+		return !std::less<const Key*>{}(keys.data(), dense.data())
+		       && std::less<const Key*>{}(keys.data(), dense.data() + dense.size());
+	}
 
-	inline const std::vector<Key>& getKeys() const { return dense; }
+	constexpr size_t size() const { return dense.size() - tombstones; }
 
-	inline std::vector<Value>& getValues() { return values; }
+	inline const std::vector<Key>& getKeys() const
+	{
+		compact();
+		return dense;
+	}
 
-	inline const std::vector<Value>& getValues() const { return values; }
+	inline ValueContainer& getValues()
+	{
+		compact();
+		return values;
+	}
+
+	inline const ValueContainer& getValues() const
+	{
+		compact();
+		return values;
+	}
 
 	constexpr size_t maxSize() const noexcept
 	{
@@ -160,6 +463,63 @@ class SparseSet {
 		sparse.clear();
 		dense.clear();
 		values.clear();
+		tombstones = 0;
+	}
+
+	// Reserve room for n values so that the next n insertions do not reallocate dense or values
+	inline void reserve(const size_t n)
+	{
+		dense.reserve(n);
+		values.reserve(n);
+	}
+
+	// Size the sparse array up front so that keys below n never trigger accommodate() to grow it
+	inline void reserveKeys(const size_t n)
+	{
+		if (n > maxSize())
+		{
+			throw std::length_error("Key exceeds the maximum size limit.");
+		}
+
+		if (n > sparse.size())
+		{
+			sparse.resize(n, empty);
+		}
+	}
+
+	constexpr size_t capacity() const noexcept { return values.capacity(); }
+
+	constexpr size_t keyCapacity() const noexcept { return sparse.size(); }
+
+	inline PoolMemoryStats memoryStats() const
+	{
+		PoolMemoryStats stats;
+		stats.sparseUsed = sparse.size() * sizeof(Index);
+		stats.sparseReserved = sparse.capacity() * sizeof(Index);
+		stats.denseUsed = size() * sizeof(Key);
+		stats.denseReserved = dense.capacity() * sizeof(Key);
+		stats.valuesUsed = size() * sizeof(Value);
+		stats.valuesReserved = values.capacity() * sizeof(Value);
+		stats.sparseFillRatio = sparse.empty() ? 0.0 : static_cast<double>(size()) / static_cast<double>(sparse.size());
+		return stats;
+	}
+
+	// Release unused memory. The sparse array is trimmed to the largest key still in use.
+	inline void shrinkToFit()
+	{
+		compact();
+		if (dense.empty())
+		{
+			sparse.clear();
+		} else
+		{
+			const Key maxKey = *std::max_element(dense.begin(), dense.end());
+			sparse.resize(static_cast<size_t>(maxKey) + 1);
+		}
+
+		sparse.shrink_to_fit();
+		dense.shrink_to_fit();
+		values.shrink_to_fit();
 	}
 };
 
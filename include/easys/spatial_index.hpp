@@ -0,0 +1,283 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sparse_set.hpp"
+
+namespace Easys {
+
+// A uniform grid over the 2D plane. Every key is stored in the cell containing its position, cells are created on
+// demand in a hash map, so the covered area is unbounded. Box and radius queries only visit the overlapping cells,
+// which makes them O(k) in the number of nearby keys instead of O(n).
+template <UnsignedIntegral Key>
+class SpatialGrid {
+   public:
+	explicit SpatialGrid(const float cellSize = 16.0f) { setCellSize(cellSize); }
+
+	// Inserts a key or moves it to a new position
+	inline void set(const Key key, const float x, const float y)
+	{
+		const uint64_t cell = cellOf(x, y);
+		if (Location* location = locations.tryGet(key))
+		{
+			if (location->cell == cell)
+			{
+				cells[cell][location->index] = {key, x, y};
+				return;
+			}
+			removeFromCell(*location);
+		}
+
+		std::vector<Entry>& entries = cells[cell];
+		locations.set(key, Location{cell, static_cast<uint32_t>(entries.size())});
+		entries.push_back({key, x, y});
+	}
+
+	inline void remove(const Key key)
+	{
+		if (const Location* location = locations.tryGet(key))
+		{
+			removeFromCell(*location);
+			locations.remove(key);
+		}
+	}
+
+	inline bool contains(const Key key) const { return locations.contains(key); }
+
+	inline size_t size() const { return locations.size(); }
+
+	inline void clear()
+	{
+		cells.clear();
+		locations.clear();
+	}
+
+	inline float cellSize() const { return cellSize_; }
+
+	// Estimated heap memory of the cells and the key locations. A hash map node holds the cell key, the entry vector,
+	// the cached hash and the next pointer.
+	inline size_t memoryBytes() const
+	{
+		constexpr size_t nodeBytes = sizeof(uint64_t) + sizeof(std::vector<Entry>) + 2 * sizeof(void*);
+
+		size_t bytes = cells.bucket_count() * sizeof(void*) + cells.size() * nodeBytes;
+		for (const auto& [cell, entries] : cells) bytes += entries.capacity() * sizeof(Entry);
+		return bytes + locations.memoryStats().reserved();
+	}
+
+	// Changes the cell size and redistributes all keys. A good cell size is about the typical query radius.
+	inline void setCellSize(const float cellSize)
+	{
+		if (!(cellSize > 0.0f)) throw std::invalid_argument("Cell size must be positive.");
+
+		cellSize_ = cellSize;
+		inverseCellSize = 1.0f / cellSize;
+
+		std::vector<Entry> entries;
+		entries.reserve(size());
+		for (const auto& [cell, cellEntries] : cells) entries.insert(entries.end(), cellEntries.begin(), cellEntries.end());
+		clear();
+		for (const Entry& entry : entries) set(entry.key, entry.x, entry.y);
+	}
+
+	// Writes all keys with a position inside the box (inclusive) to result, replacing its contents
+	inline void queryBox(const float minX, const float minY, const float maxX, const float maxY,
+	                     std::vector<Key>& result) const
+	{
+		result.clear();
+		forEachCell(minX,
+		            minY,
+		            maxX,
+		            maxY,
+		            [&](const Entry& entry)
+		            {
+			            if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY)
+			            {
+				            result.push_back(entry.key);
+			            }
+		            });
+	}
+
+	// Writes all keys with a position within radius of (x, y) (inclusive) to result, replacing its contents
+	inline void queryRadius(const float x, const float y, const float radius, std::vector<Key>& result) const
+	{
+		result.clear();
+		const float radiusSquared = radius * radius;
+		forEachCell(x - radius,
+		            y - radius,
+		            x + radius,
+		            y + radius,
+		            [&](const Entry& entry)
+		            {
+			            const float dx = entry.x - x;
+			            const float dy = entry.y - y;
+			            if (dx * dx + dy * dy <= radiusSquared) result.push_back(entry.key);
+		            });
+	}
+
+   private:
+	struct Entry {
+		Key key;
+		float x, y;  // cached, so queries do not have to look up the components
+	};
+
+	struct Location {
+		uint64_t cell;
+		uint32_t index;  // within the cell
+	};
+
+	float cellSize_ = 16.0f;
+	float inverseCellSize = 1.0f / 16.0f;
+	std::unordered_map<uint64_t, std::vector<Entry>> cells;
+	SparseSet<Key, Location> locations;
+
+	inline int32_t coordinate(const float value) const
+	{
+		constexpr float limit = static_cast<float>(std::numeric_limits<int32_t>::max() / 2);
+		const float scaled = std::floor(value * inverseCellSize);
+		return static_cast<int32_t>(std::fmax(-limit, std::fmin(limit, scaled)));
+	}
+
+	static inline uint64_t cellKey(const int32_t cx, const int32_t cy)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+	}
+
+	inline uint64_t cellOf(const float x, const float y) const { return cellKey(coordinate(x), coordinate(y)); }
+
+	// Swap-and-pop within the cell, keeping the location of the moved entry up to date
+	inline void removeFromCell(const Location location)
+	{
+		auto it = cells.find(location.cell);
+		std::vector<Entry>& entries = it->second;
+		if (location.index != entries.size() - 1)
+		{
+			entries[location.index] = entries.back();
+			locations.get(entries[location.index].key).index = location.index;
+		}
+		entries.pop_back();
+		if (entries.empty()) cells.erase(it);
+	}
+
+	template <typename Func>
+	inline void forEachCell(const float minX, const float minY, const float maxX, const float maxY, Func&& func) const
+	{
+		if (cells.empty() || !(minX <= maxX) || !(minY <= maxY)) return;
+
+		const int32_t minCellX = coordinate(minX), maxCellX = coordinate(maxX);
+		const int32_t minCellY = coordinate(minY), maxCellY = coordinate(maxY);
+
+		// For huge boxes walking the occupied cells is cheaper than probing every covered one
+		const double covered = (static_cast<double>(maxCellX) - minCellX + 1) * (static_cast<double>(maxCellY) - minCellY + 1);
+		if (covered > static_cast<double>(cells.size()))
+		{
+			for (const auto& [cell, entries] : cells)
+			{
+				for (const Entry& entry : entries) func(entry);
+			}
+			return;
+		}
+
+		for (int32_t cx = minCellX; cx <= maxCellX; cx++)
+		{
+			for (int32_t cy = minCellY; cy <= maxCellY; cy++)
+			{
+				auto it = cells.find(cellKey(cx, cy));
+				if (it == cells.end()) continue;
+				for (const Entry& entry : it->second) func(entry);
+			}
+		}
+	}
+};
+
+// A SparseSet that keeps a SpatialGrid in sync with the positions of its values. PositionOf is a default
+// constructible callable returning the position of a value as something that destructures into two floats, e.g.
+// std::array<float, 2>. Opt a component type in through ComponentStorage, see storage.hpp.
+//
+// Adding, replacing and removing values updates the grid. Values that are modified in place, e.g. through
+// getComponent() or forEach(), have to be reported with update() or updateAll().
+template <UnsignedIntegral Key, typename Value, typename PositionOf>
+class SpatialSparseSet : public SparseSet<Key, Value> {
+	using Base = SparseSet<Key, Value>;
+
+   public:
+	inline void set(const Key key, const Value& value)
+	{
+		Base::set(key, value);
+		track(key, value);
+	}
+
+	inline void set(const Key key, Value&& value)
+	{
+		Base::set(key, std::move(value));
+		track(key, Base::get(key));
+	}
+
+	inline void set(std::span<const Key> keys, const Value& value)
+	{
+		Base::set(keys, value);
+		for (const Key key : keys) track(key, value);
+	}
+
+	inline void remove(const Key key)
+	{
+		Base::remove(key);
+		grid_.remove(key);
+	}
+
+	inline void remove(std::span<const Key> keys, const bool preserveOrder = false)
+	{
+		for (const Key key : keys) grid_.remove(key);
+		Base::remove(keys, preserveOrder);
+	}
+
+	inline void clear()
+	{
+		Base::clear();
+		grid_.clear();
+	}
+
+	// Re-read the position of a single value after it was modified in place
+	inline void update(const Key key)
+	{
+		if (const Value* value = Base::tryGet(key)) track(key, *value);
+	}
+
+	// Re-read the positions of all values, e.g. once per frame after a movement system ran
+	inline void updateAll()
+	{
+		const auto& keys = Base::getKeys();
+		const auto& values = Base::getValues();
+		for (size_t i = 0; i < keys.size(); i++) track(keys[i], values[i]);
+	}
+
+	// Includes the grid, which usually outweighs the pool itself
+	inline PoolMemoryStats memoryStats() const
+	{
+		PoolMemoryStats stats = Base::memoryStats();
+		stats.indexBytes = grid_.memoryBytes();
+		return stats;
+	}
+
+	inline const SpatialGrid<Key>& grid() const { return grid_; }
+	inline SpatialGrid<Key>& grid() { return grid_; }
+
+   private:
+	SpatialGrid<Key> grid_;
+
+	inline void track(const Key key, const Value& value)
+	{
+		const auto [x, y] = PositionOf{}(value);
+		grid_.set(key, static_cast<float>(x), static_cast<float>(y));
+	}
+};
+
+}  // namespace Easys
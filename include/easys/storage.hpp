@@ -0,0 +1,159 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "chunked_vector.hpp"
+#include "double_buffered_sparse_set.hpp"
+#include "huge_page_allocator.hpp"
+#include "pool_access.hpp"
+#include "spatial_index.hpp"
+#include "sparse_set.hpp"
+#include "type_index.hpp"
+
+namespace Easys {
+
+// A SparseSet whose values live in fixed size chunks. Adding components never moves existing ones, so references
+// returned by getComponent() stay valid until that component is removed. Removal still swaps the last element into
+// the hole, which means the moved element (and only that one) changes its address.
+template <typename Key, typename Value, size_t ChunkSize = 1024>
+using ChunkedSparseSet = SparseSet<Key, Value, ChunkedVector<Value, ChunkSize>>;
+
+// A SparseSet which keeps the relative order of its values on removal. Removed slots are left as tombstones and
+// compacted in one pass later on, either once half of the slots are dead or when the keys or values are accessed.
+// Useful for pools that are sorted once and iterated in that order for many frames.
+template <typename Key, typename Value>
+using StableSparseSet = SparseSet<Key, Value, std::vector<Value>, DeletionPolicy::InPlace>;
+
+// The narrowest unsigned type that can index MaxPopulation values, keeping its largest value free as the empty marker.
+// Selected by bit width, since comparing against the limits of the narrow types trips GCC's -Wtype-limits.
+template <size_t MaxPopulation>
+using CompactIndex =
+    std::conditional_t<(std::bit_width(uint64_t{MaxPopulation}) <= 8),
+                       uint8_t,
+                       std::conditional_t<(std::bit_width(uint64_t{MaxPopulation}) <= 16),
+                                          uint16_t,
+                                          std::conditional_t<(std::bit_width(uint64_t{MaxPopulation}) <= 32),
+                                                             uint32_t,
+                                                             uint64_t>>>;
+
+// A SparseSet for component types of which at most MaxPopulation exist at a time, e.g. a few hundred cameras or
+// lights in a world of a million entities. The sparse array has a slot for every entity ID, which dominates the memory
+// of such rare types; storing the slots as CompactIndex<MaxPopulation> halves it for uint16_t and quarters it for
+// uint8_t. Adding more values than the index type can address throws std::length_error.
+template <typename Key, typename Value, size_t MaxPopulation>
+using CompactSparseSet =
+    SparseSet<Key, Value, std::vector<Value>, DeletionPolicy::SwapAndPop, CompactIndex<MaxPopulation>>;
+
+// A SparseSet whose values are backed by huge pages once they reach 2 MiB, for pools of millions of components where
+// TLB misses make up a noticeable part of random accesses. Placement binds the pages to NUMA nodes, see
+// HugePageAllocator.
+template <typename Key,
+          typename Value,
+          HugePages Pages = HugePages::Transparent,
+          NumaPlacement Placement = NumaPlacement::FirstTouch>
+using HugePageSparseSet = SparseSet<Key, Value, std::vector<Value, HugePageAllocator<Value, Pages, Placement>>>;
+
+// Selects the pool type the Registry uses for a component type. The default is a plain SparseSet. Specialize this
+// to opt a single component type into a different storage policy, e.g.:
+//
+//   template <typename Key>
+//   struct Easys::ComponentStorage<Key, Transform> {
+//       using type = Easys::ChunkedSparseSet<Key, Transform>;
+//   };
+//
+// A SpatialSparseSet additionally keeps a grid of the component positions for ECS::queryBox() and queryRadius():
+//
+//   struct PositionOf {
+//       std::array<float, 2> operator()(const Position& p) const { return {p.x, p.y}; }
+//   };
+//   template <typename Key>
+//   struct Easys::ComponentStorage<Key, Position> {
+//       using type = Easys::SpatialSparseSet<Key, Position, PositionOf>;
+//   };
+//
+// Rare component types can use a narrower index type for their sparse array:
+//
+//   template <typename Key>
+//   struct Easys::ComponentStorage<Key, Camera> {
+//       using type = Easys::CompactSparseSet<Key, Camera, 256>;
+//   };
+//
+// Very large pools can be backed by huge pages:
+//
+//   template <typename Key>
+//   struct Easys::ComponentStorage<Key, Transform> {
+//       using type = Easys::HugePageSparseSet<Key, Transform>;
+//   };
+//
+// A DoubleBufferedSparseSet keeps last tick's values readable through ECS::getFrontComponent() while this tick's are
+// written, see ECS::swapBuffers().
+//
+// The specialization has to be visible before the ECS for that component type is instantiated.
+template <typename Key, typename Component>
+struct ComponentStorage {
+	using type = SparseSet<Key, Component>;
+};
+
+template <typename Key, typename Component>
+using ComponentStorageType = typename ComponentStorage<Key, Component>::type;
+
+template <size_t Index, typename Pool>
+struct PoolSlot {
+	Pool pool;
+	[[no_unique_address]] PoolAccess<defaultAccessMode> access;
+};
+
+template <typename Indices, typename... Pools>
+struct PoolSlots;
+
+template <size_t... Indices, typename... Pools>
+struct PoolSlots<std::index_sequence<Indices...>, Pools...> : PoolSlot<Indices, Pools>... {
+};
+
+// Holds one pool per component type. std::tuple is a chain of nested base classes and std::get<T> searches it
+// recursively, which gets expensive to compile for hundreds of component types. Here every pool is a direct base
+// and is found by its constexpr index through overload resolution.
+template <typename Key, typename... Components>
+class ComponentPools {
+   public:
+	template <typename Component>
+	inline ComponentStorageType<Key, Component>& get()
+	{
+		return slot<typeIndex<Component, Components...>>(slots).pool;
+	}
+
+	template <typename Component>
+	inline const ComponentStorageType<Key, Component>& get() const
+	{
+		return slot<typeIndex<Component, Components...>>(slots).pool;
+	}
+
+	template <typename Component>
+	inline PoolAccess<defaultAccessMode>& access()
+	{
+		return slot<typeIndex<Component, Components...>>(slots).access;
+	}
+
+   private:
+	PoolSlots<std::index_sequence_for<Components...>, ComponentStorageType<Key, Components>...> slots;
+
+	// The pool type is deduced from the base class with the matching index
+	template <size_t Index, typename Pool>
+	static inline PoolSlot<Index, Pool>& slot(PoolSlot<Index, Pool>& slot)
+	{
+		return slot;
+	}
+
+	template <size_t Index, typename Pool>
+	static inline const PoolSlot<Index, Pool>& slot(const PoolSlot<Index, Pool>& slot)
+	{
+		return slot;
+	}
+};
+
+}  // namespace Easys
@@ -0,0 +1,355 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "entity.hpp"
+#include "sparse_set.hpp"
+
+namespace Easys {
+
+class AsyncScheduler;
+
+// Recycles the coroutine frames of Tasks in per-thread free lists by size class, so that spawning thousands of tasks
+// per tick does not go through the global allocator. Frames larger than the biggest class are allocated directly.
+class FramePool {
+   public:
+	static inline void* allocate(const size_t size)
+	{
+		const size_t sizeClass = classOf(size);
+		if (sizeClass >= classes || destroyed) return ::operator new(size);
+
+		std::vector<void*>& frames = local().freeLists[sizeClass];
+		if (frames.empty()) return ::operator new((sizeClass + 1) * granularity);
+		void* frame = frames.back();
+		frames.pop_back();
+		return frame;
+	}
+
+	static inline void deallocate(void* frame, const size_t size)
+	{
+		const size_t sizeClass = classOf(size);
+		if (sizeClass >= classes || destroyed)
+		{
+			::operator delete(frame);
+			return;
+		}
+		local().freeLists[sizeClass].push_back(frame);
+	}
+
+	~FramePool()
+	{
+		destroyed = true;  // frames released later, e.g. by static objects at exit, go straight to the allocator
+		for (auto& frames : freeLists)
+		{
+			for (void* frame : frames) ::operator delete(frame);
+		}
+	}
+
+   private:
+	static constexpr size_t granularity = 64;
+	static constexpr size_t classes = 16;  // frames of up to 1 KiB
+
+	static inline thread_local bool destroyed = false;
+	std::array<std::vector<void*>, classes> freeLists;
+
+	static inline FramePool& local()
+	{
+		thread_local FramePool pool;
+		return pool;
+	}
+
+	static constexpr size_t classOf(const size_t size) { return size == 0 ? 0 : (size - 1) / granularity; }
+};
+
+// Identifies one spawned task. The serial tells a respawned task apart from an older one of the same entity.
+struct TaskRef {
+	Entity entity;
+	uint64_t serial;
+};
+
+// Tasks that can be resumed by the next AsyncScheduler::run(). Shared with pending operations, so that an operation
+// completing after its scheduler is gone does not touch freed memory.
+class ReadyQueue {
+   public:
+	inline void push(const TaskRef task)
+	{
+		std::lock_guard lock(mutex);
+		ready.push_back(task);
+	}
+
+	inline std::vector<TaskRef> take()
+	{
+		std::lock_guard lock(mutex);
+		return std::exchange(ready, {});
+	}
+
+   private:
+	std::mutex mutex;
+	std::vector<TaskRef> ready;
+};
+
+// The coroutine type of asynchronous per-entity work, e.g.
+//
+//   Easys::Task loadMesh(World& world, Easys::Entity e) {
+//       Mesh mesh = co_await assets.load(world.getComponent<MeshRef>(e).path);
+//       world.addComponent(e, mesh);
+//   }
+//
+// A task is started by AsyncScheduler::spawn() (or ECS::spawnTask()) and runs until it awaits an AsyncOperation or
+// nextTick(). It is resumed by AsyncScheduler::run() once the awaited result is available. References to components
+// must not be kept across a co_await, since the pools may change while the task is suspended.
+class Task {
+   public:
+	struct promise_type {
+		AsyncScheduler* scheduler = nullptr;
+		TaskRef ref{NULL_ENTITY, 0};
+		std::exception_ptr error;
+
+		inline Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		inline std::suspend_always initial_suspend() noexcept { return {}; }
+		inline std::suspend_always final_suspend() noexcept { return {}; }
+		inline void return_void() {}
+		inline void unhandled_exception() { error = std::current_exception(); }
+
+		static inline void* operator new(const size_t size) { return FramePool::allocate(size); }
+		static inline void operator delete(void* frame, const size_t size) { FramePool::deallocate(frame, size); }
+	};
+
+	using Handle = std::coroutine_handle<promise_type>;
+
+	Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+	Task& operator=(Task&&) = delete;
+
+	~Task()
+	{
+		if (handle) handle.destroy();
+	}
+
+	// Hands the coroutine over, the Task no longer owns it
+	inline Handle release() { return std::exchange(handle, {}); }
+
+   private:
+	Handle handle;
+
+	explicit Task(const Handle handle) : handle(handle) {}
+};
+
+// Runs the tasks of a world, at most one per entity. Suspended tasks are kept in a SparseSet keyed by entity, so the
+// per-entity state is compact and cancelled together with the entity. run() resumes all tasks whose awaited result
+// arrived and is meant to be called once per tick on the thread owning the world. Operations may complete on any
+// thread.
+class AsyncScheduler {
+   public:
+	AsyncScheduler() = default;
+
+	// Tasks keep references to the world they were spawned for, e.g. a World& parameter, so a scheduler with pending
+	// tasks can neither be copied nor moved: both throw std::logic_error. An idle scheduler is copied and moved empty.
+	AsyncScheduler(const AsyncScheduler& other) { requireIdle(other); }
+	AsyncScheduler(AsyncScheduler&& other) { requireIdle(other); }
+
+	AsyncScheduler& operator=(const AsyncScheduler& other)
+	{
+		requireIdle(other);
+		clear();  // serials keep counting, so that stale entries of the ready queue stay ignored
+		return *this;
+	}
+
+	AsyncScheduler& operator=(AsyncScheduler&& other) { return *this = static_cast<const AsyncScheduler&>(other); }
+
+	~AsyncScheduler() { clear(); }
+
+	// Starts a task for an entity, replacing (cancelling) the entity's previous task. The task runs right away until
+	// it first suspends. Throws std::logic_error if the entity's task is currently running, e.g. spawns itself.
+	inline void spawn(const Entity entity, Task task)
+	{
+		if (isRunning(entity)) throw std::logic_error("A running task cannot be replaced.");
+		cancel(entity);
+
+		const Task::Handle handle = task.release();
+		handle.promise().scheduler = this;
+		handle.promise().ref = {entity, nextSerial++};
+		tasks.set(entity, handle);
+		resume(entity);
+		if (runningStack.empty()) rethrowError();  // a nested spawn reports through the outer run()
+	}
+
+	// Resumes every task whose awaited result became available since the last call. A task that throws is removed,
+	// the first exception is rethrown after all other ready tasks ran. Returns the number of resumed tasks.
+	inline size_t run()
+	{
+		if (!ready) return 0;
+
+		size_t resumed = 0;
+		for (const TaskRef ref : ready->take())
+		{
+			const Task::Handle* handle = tasks.tryGet(ref.entity);
+			if (!handle || handle->promise().ref.serial != ref.serial) continue;  // cancelled in the meantime
+			resume(ref.entity);
+			resumed++;
+		}
+		rethrowError();
+		return resumed;
+	}
+
+	// Destroys the task of an entity. A task cancelling itself is destroyed once it suspends.
+	inline void cancel(const Entity entity)
+	{
+		if (!tasks.contains(entity)) return;
+		for (Running& running : runningStack)
+		{
+			if (running.entity == entity)
+			{
+				running.cancelled = true;
+				return;
+			}
+		}
+		tasks.get(entity).destroy();
+		tasks.remove(entity);
+	}
+
+	inline bool contains(const Entity entity) const { return tasks.contains(entity); }
+
+	inline size_t size() const { return tasks.size(); }
+
+	// Destroys all tasks. Called from within a task, the running tasks are destroyed once they suspend, like cancel().
+	inline void clear()
+	{
+		if (!runningStack.empty())
+		{
+			const std::vector<Entity> entities = tasks.getKeys();
+			for (const Entity entity : entities) cancel(entity);
+			return;
+		}
+		for (const Entity entity : tasks.getKeys()) tasks.get(entity).destroy();
+		tasks.clear();
+	}
+
+	// The queue that completed operations push their waiting task to
+	inline const std::shared_ptr<ReadyQueue>& readyQueue()
+	{
+		if (!ready) ready = std::make_shared<ReadyQueue>();  // created lazily, so that idle worlds stay cheap
+		return ready;
+	}
+
+   private:
+	struct Running {
+		Entity entity;
+		bool cancelled;
+	};
+
+	SparseSet<Entity, Task::Handle> tasks;
+	std::shared_ptr<ReadyQueue> ready;
+	uint64_t nextSerial = 0;
+	std::vector<Running> runningStack;  // a task may spawn another one, which runs nested
+	std::exception_ptr error;
+
+	static inline void requireIdle(const AsyncScheduler& other)
+	{
+		if (other.size() > 0) throw std::logic_error("A world with pending tasks cannot be copied or moved.");
+	}
+
+	inline bool isRunning(const Entity entity) const
+	{
+		for (const Running& running : runningStack)
+		{
+			if (running.entity == entity) return true;
+		}
+		return false;
+	}
+
+	inline void resume(const Entity entity)
+	{
+		// Copy the handle, the pool may change while the task runs
+		const Task::Handle handle = tasks.get(entity);
+		runningStack.push_back({entity, false});
+		handle.resume();
+		const bool cancelled = runningStack.back().cancelled;
+		runningStack.pop_back();
+
+		if (!cancelled && !handle.done()) return;
+		if (!cancelled && handle.promise().error && !error) error = handle.promise().error;
+		handle.destroy();
+		tasks.remove(entity);
+	}
+
+	inline void rethrowError()
+	{
+		if (error) std::rethrow_exception(std::exchange(error, nullptr));
+	}
+};
+
+// The result of an asynchronous operation, e.g. an asset load or a database query, that a Task can co_await. The
+// producer keeps a copy and calls complete() from any thread, the awaiting task is then resumed by the next
+// AsyncScheduler::run(). Copies share the same state. Only one task may await an operation.
+template <typename T>
+class AsyncOperation {
+   public:
+	// Thread-safe. Throws std::logic_error if the operation was already completed.
+	inline void complete(T value)
+	{
+		std::lock_guard lock(state->mutex);
+		if (state->value) throw std::logic_error("The operation was already completed.");
+		state->value = std::move(value);
+		if (state->queue) state->queue->push(state->waiter);
+	}
+
+	inline bool isComplete() const
+	{
+		std::lock_guard lock(state->mutex);
+		return state->value.has_value();
+	}
+
+	inline bool await_ready() const { return isComplete(); }
+
+	inline bool await_suspend(const Task::Handle handle)
+	{
+		std::lock_guard lock(state->mutex);
+		if (state->value) return false;  // completed in the meantime, continue right away
+		if (state->queue) throw std::logic_error("Only one task may await an operation.");
+		state->waiter = handle.promise().ref;
+		state->queue = handle.promise().scheduler->readyQueue();
+		return true;
+	}
+
+	inline T await_resume()
+	{
+		std::lock_guard lock(state->mutex);
+		return std::move(*state->value);
+	}
+
+   private:
+	struct State {
+		mutable std::mutex mutex;
+		std::optional<T> value;
+		std::shared_ptr<ReadyQueue> queue;  // set once a task awaits the operation
+		TaskRef waiter{NULL_ENTITY, 0};
+	};
+
+	std::shared_ptr<State> state = std::make_shared<State>();
+};
+
+// Suspends a task until the next AsyncScheduler::run(), e.g. to spread work over several ticks
+struct NextTick {
+	inline bool await_ready() const noexcept { return false; }
+
+	inline void await_suspend(const Task::Handle handle) const
+	{
+		handle.promise().scheduler->readyQueue()->push(handle.promise().ref);
+	}
+
+	inline void await_resume() const noexcept {}
+};
+
+inline NextTick nextTick() { return {}; }
+
+}  // namespace Easys
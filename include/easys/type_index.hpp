@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+namespace Easys {
+
+// Position of T in Ts..., or sizeof...(Ts) if T is not part of the list. Computed by a constexpr loop over a single
+// array instead of recursive template instantiations, so the cost stays flat for long component lists.
+template <typename T, typename... Ts>
+inline constexpr size_t typeIndex = []
+{
+	constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+	size_t index = 0;
+	while (index < sizeof...(Ts) && !matches[index]) index++;
+	return index;
+}();
+
+template <typename T, typename... Ts>
+inline constexpr bool containsType = typeIndex<T, Ts...> < sizeof...(Ts);
+
+}  // namespace Easys
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+
+#include <cstdlib>
+#endif
+
+namespace Easys {
+
+// A readable name of a type for diagnostics, e.g. "Position". The returned string lives forever.
+template <typename T>
+inline const char* typeName()
+{
+	static const std::string name = []
+	{
+		const char* mangled = typeid(T).name();
+#if defined(__GNUG__)
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+		std::string result = status == 0 && demangled ? demangled : mangled;
+		std::free(demangled);
+		return result;
+#else
+		return std::string(mangled);
+#endif
+	}();
+	return name.c_str();
+}
+
+}  // namespace Easys
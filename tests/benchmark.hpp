@@ -0,0 +1,605 @@
+#pragma once
+
+// A small Google-Benchmark-style harness used by the microbenchmark targets. It runs each registered benchmark for a
+// set of arguments, calibrates the iteration count to a minimum run time, does warmup runs and then reports
+// statistics over several repetitions on the console or as JSON/CSV. With --perf-counters, hardware counters (cycles,
+// instructions, cache/TLB and branch misses) are collected for the timed regions and reported per processed item.
+//
+// Usage:
+//   void BM_Something(Bench::State& state)
+//   {
+//       setup(state.range(0));
+//       for (auto _ : state)
+//       {
+//           Bench::doNotOptimize(work());
+//       }
+//       state.setItemsProcessed(state.iterations() * state.range(0));
+//   }
+//   EASYS_BENCHMARK(BM_Something)->argName("entities")->args({1000, 10000});
+//   EASYS_BENCHMARK_MAIN();
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "perf_counters.hpp"
+
+namespace Bench {
+
+// Prevents the compiler from optimizing away a value or the computation producing it.
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+// Forces all pending memory writes to be considered visible, so stores are not optimized away.
+inline void clobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : : "memory");
+#endif
+}
+
+class State {
+   public:
+	using Clock = std::chrono::steady_clock;
+
+	State(std::vector<int64_t> args, size_t iterations, PerfCounters* perf = nullptr)
+	    : args_(std::move(args)), iterations_(iterations), perf_(perf)
+	{
+	}
+
+	int64_t range(size_t index = 0) const { return args_.at(index); }
+	const std::vector<int64_t>& args() const { return args_; }
+	size_t iterations() const { return iterations_; }
+
+	// Exclude code (e.g. per iteration setup) from the measurement
+	void pauseTiming()
+	{
+		elapsed_ += Clock::now() - start_;
+		if (perf_) perf_->stop();
+		running_ = false;
+	}
+
+	void resumeTiming()
+	{
+		running_ = true;
+		if (perf_) perf_->start();
+		start_ = Clock::now();
+	}
+
+	// Number of processed items in total over all iterations, reported as items per second
+	void setItemsProcessed(int64_t items) { itemsProcessed_ = items; }
+	int64_t itemsProcessed() const { return itemsProcessed_; }
+
+	// Additional values reported per repetition, e.g. hardware counters
+	std::map<std::string, double> counters;
+
+	double elapsedSeconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+
+	// The type of the loop variable in `for (auto _ : state)`, marked so that the unused variable does not warn
+	struct [[maybe_unused]] Value {
+	};
+
+	struct Iterator {
+		State* state;
+		size_t remaining;
+
+		bool operator!=(const Iterator&)
+		{
+			if (remaining != 0) return true;
+			state->finish();
+			return false;
+		}
+
+		void operator++() { remaining--; }
+		Value operator*() const { return {}; }
+	};
+
+	Iterator begin()
+	{
+		resumeTiming();
+		return {this, iterations_};
+	}
+
+	Iterator end() { return {this, 0}; }
+
+   private:
+	std::vector<int64_t> args_;
+	size_t iterations_;
+	PerfCounters* perf_;
+	int64_t itemsProcessed_ = 0;
+	bool running_ = false;
+	Clock::time_point start_;
+	Clock::duration elapsed_ = Clock::duration::zero();
+
+	void finish()
+	{
+		if (running_) pauseTiming();
+	}
+};
+
+class Benchmark {
+   public:
+	Benchmark(std::string name, std::function<void(State&)> fn) : name_(std::move(name)), fn_(std::move(fn)) {}
+
+	// Run the benchmark once for every value of a single argument
+	Benchmark* args(const std::vector<int64_t>& values)
+	{
+		for (int64_t value : values) argSets_.push_back({value});
+		return this;
+	}
+
+	// Run the benchmark for the cartesian product of the given argument lists
+	Benchmark* argsProduct(const std::vector<std::vector<int64_t>>& lists)
+	{
+		std::vector<std::vector<int64_t>> product = {{}};
+		for (const auto& list : lists)
+		{
+			std::vector<std::vector<int64_t>> next;
+			for (const auto& prefix : product)
+			{
+				for (int64_t value : list)
+				{
+					next.push_back(prefix);
+					next.back().push_back(value);
+				}
+			}
+			product = std::move(next);
+		}
+		argSets_.insert(argSets_.end(), product.begin(), product.end());
+		return this;
+	}
+
+	Benchmark* argName(std::string name)
+	{
+		argNames_ = {std::move(name)};
+		return this;
+	}
+
+	Benchmark* argNames(std::vector<std::string> names)
+	{
+		argNames_ = std::move(names);
+		return this;
+	}
+
+	const std::string& name() const { return name_; }
+	const std::vector<std::vector<int64_t>>& argSets() const { return argSets_; }
+	const std::vector<std::string>& argNames() const { return argNames_; }
+	void run(State& state) const { fn_(state); }
+
+	std::string fullName(const std::vector<int64_t>& args) const
+	{
+		std::string result = name_;
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			result += "/";
+			if (i < argNames_.size()) result += argNames_[i] + ":";
+			result += std::to_string(args[i]);
+		}
+		return result;
+	}
+
+   private:
+	std::string name_;
+	std::function<void(State&)> fn_;
+	std::vector<std::vector<int64_t>> argSets_;
+	std::vector<std::string> argNames_;
+};
+
+inline std::vector<std::unique_ptr<Benchmark>>& benchmarks()
+{
+	static std::vector<std::unique_ptr<Benchmark>> registered;
+	return registered;
+}
+
+inline Benchmark* registerBenchmark(std::string name, std::function<void(State&)> fn)
+{
+	benchmarks().push_back(std::make_unique<Benchmark>(std::move(name), std::move(fn)));
+	return benchmarks().back().get();
+}
+
+struct Options {
+	std::string filter = ".*";
+	std::string format = "console";
+	std::string out;
+	size_t repetitions = 10;
+	size_t warmup = 1;
+	double minTime = 0.05;  // seconds per repetition
+	bool list = false;
+	bool perfCounters = false;
+};
+
+// Summary of a set of samples
+struct Statistics {
+	double min = 0, max = 0, mean = 0, median = 0, stddev = 0, p90 = 0, p99 = 0;
+
+	static double percentile(const std::vector<double>& sorted, double p)
+	{
+		if (sorted.empty()) return 0;
+		const double rank = p * static_cast<double>(sorted.size() - 1);
+		const size_t lower = static_cast<size_t>(std::floor(rank));
+		const size_t upper = std::min(lower + 1, sorted.size() - 1);
+		return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+	}
+
+	static Statistics of(std::vector<double> samples)
+	{
+		Statistics stats;
+		if (samples.empty()) return stats;
+
+		std::sort(samples.begin(), samples.end());
+		const double n = static_cast<double>(samples.size());
+		stats.min = samples.front();
+		stats.max = samples.back();
+		stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+		stats.median = percentile(samples, 0.5);
+		stats.p90 = percentile(samples, 0.9);
+		stats.p99 = percentile(samples, 0.99);
+
+		double squares = 0;
+		for (double sample : samples) squares += (sample - stats.mean) * (sample - stats.mean);
+		stats.stddev = samples.size() > 1 ? std::sqrt(squares / (n - 1)) : 0;
+		return stats;
+	}
+};
+
+struct Result {
+	std::string name;
+	std::vector<int64_t> args;
+	size_t iterations = 0;
+	size_t repetitions = 0;
+	Statistics timeNs;         // time per iteration
+	double itemsPerSecond = 0;  // based on the median repetition time
+	std::map<std::string, Statistics> counters;
+};
+
+inline Options parseOptions(int argc, char* argv[])
+{
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		auto value = [&arg](const std::string& prefix) { return arg.substr(prefix.size()); };
+
+		if (arg.rfind("--filter=", 0) == 0)
+			options.filter = value("--filter=");
+		else if (arg.rfind("--format=", 0) == 0)
+			options.format = value("--format=");
+		else if (arg.rfind("--out=", 0) == 0)
+			options.out = value("--out=");
+		else if (arg.rfind("--repetitions=", 0) == 0)
+			options.repetitions = std::max<size_t>(1, std::stoul(value("--repetitions=")));
+		else if (arg.rfind("--warmup=", 0) == 0)
+			options.warmup = std::stoul(value("--warmup="));
+		else if (arg.rfind("--min-time=", 0) == 0)
+			options.minTime = std::stod(value("--min-time="));
+		else if (arg == "--list")
+			options.list = true;
+		else if (arg == "--perf-counters")
+			options.perfCounters = true;
+		else
+		{
+			const bool help = arg == "--help";
+			(help ? std::cout : std::cerr)
+			    << (help ? "" : "Unknown option: " + arg + "\n")
+			    << "Options: --filter=<regex> --format=console|json|csv --out=<file> --repetitions=<n> "
+			       "--warmup=<n> --min-time=<seconds> --perf-counters --list\n";
+			std::exit(help ? 0 : 2);
+		}
+	}
+
+	if (options.format != "console" && options.format != "json" && options.format != "csv")
+	{
+		std::cerr << "Unknown format: " << options.format << "\n";
+		std::exit(2);
+	}
+	return options;
+}
+
+// Hardware counters of one repetition, normalized per processed item (or per iteration if no items were set)
+inline void addPerfCounters(State& state, const PerfCounters& perf)
+{
+	const double items = static_cast<double>(state.itemsProcessed() > 0 ? state.itemsProcessed() : state.iterations());
+	double cycles = 0, instructions = 0;
+
+	for (const auto& [name, value] : perf.read())
+	{
+		state.counters[name + "/item"] = value / items;
+		if (name == "cycles") cycles = value;
+		if (name == "instructions") instructions = value;
+	}
+	if (cycles > 0 && instructions > 0) state.counters["IPC"] = instructions / cycles;
+}
+
+inline Result runBenchmark(const Benchmark& benchmark,
+                           const std::vector<int64_t>& args,
+                           const Options& options,
+                           PerfCounters* perf = nullptr)
+{
+	// Calibrate the number of iterations so that a single repetition runs for at least minTime. This doubles as
+	// the first warmup run.
+	size_t iterations = 1;
+	while (true)
+	{
+		State state(args, iterations);
+		benchmark.run(state);
+		const double elapsed = state.elapsedSeconds();
+		if (elapsed >= options.minTime || iterations >= 1'000'000'000) break;
+
+		const double multiplier = elapsed > 0 ? options.minTime * 1.4 / elapsed : 10.0;
+		iterations = static_cast<size_t>(std::ceil(static_cast<double>(iterations) * std::clamp(multiplier, 1.5, 10.0)));
+	}
+
+	for (size_t i = 0; i < options.warmup; i++)
+	{
+		State state(args, iterations);
+		benchmark.run(state);
+	}
+
+	std::vector<double> times;
+	std::vector<double> seconds;
+	std::map<std::string, std::vector<double>> counters;
+	int64_t items = 0;
+
+	for (size_t i = 0; i < options.repetitions; i++)
+	{
+		if (perf) perf->reset();
+		State state(args, iterations, perf);
+		benchmark.run(state);
+		if (perf) addPerfCounters(state, *perf);
+		seconds.push_back(state.elapsedSeconds());
+		times.push_back(state.elapsedSeconds() * 1e9 / static_cast<double>(iterations));
+		items = state.itemsProcessed();
+		for (const auto& [name, value] : state.counters) counters[name].push_back(value);
+	}
+
+	Result result;
+	result.name = benchmark.fullName(args);
+	result.args = args;
+	result.iterations = iterations;
+	result.repetitions = options.repetitions;
+	result.timeNs = Statistics::of(times);
+
+	const double medianSeconds = Statistics::of(seconds).median;
+	result.itemsPerSecond = medianSeconds > 0 ? static_cast<double>(items) / medianSeconds : 0;
+	for (const auto& [name, values] : counters) result.counters[name] = Statistics::of(values);
+	return result;
+}
+
+inline std::string formatTime(double ns)
+{
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(2);
+	if (ns >= 1e9)
+		oss << ns / 1e9 << " s";
+	else if (ns >= 1e6)
+		oss << ns / 1e6 << " ms";
+	else if (ns >= 1e3)
+		oss << ns / 1e3 << " us";
+	else
+		oss << ns << " ns";
+	return oss.str();
+}
+
+inline std::string formatRate(double perSecond)
+{
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(2);
+	if (perSecond >= 1e9)
+		oss << perSecond / 1e9 << "G/s";
+	else if (perSecond >= 1e6)
+		oss << perSecond / 1e6 << "M/s";
+	else if (perSecond >= 1e3)
+		oss << perSecond / 1e3 << "k/s";
+	else
+		oss << perSecond << "/s";
+	return oss.str();
+}
+
+inline void printConsoleHeader(std::ostream& os)
+{
+	os << std::left << std::setw(56) << "Benchmark" << std::right << std::setw(12) << "Median" << std::setw(12)
+	   << "p90" << std::setw(12) << "p99" << std::setw(10) << "CV" << std::setw(12) << "Iterations" << std::setw(14)
+	   << "Items/s" << "\n"
+	   << std::string(128, '-') << "\n";
+}
+
+inline void printConsoleResult(std::ostream& os, const Result& result)
+{
+	const double cv = result.timeNs.mean > 0 ? result.timeNs.stddev / result.timeNs.mean * 100 : 0;
+	std::ostringstream cvText;
+	cvText << std::fixed << std::setprecision(1) << cv << "%";
+
+	os << std::left << std::setw(56) << result.name << std::right << std::setw(12) << formatTime(result.timeNs.median)
+	   << std::setw(12) << formatTime(result.timeNs.p90) << std::setw(12) << formatTime(result.timeNs.p99)
+	   << std::setw(10) << cvText.str() << std::setw(12) << result.iterations << std::setw(14)
+	   << (result.itemsPerSecond > 0 ? formatRate(result.itemsPerSecond) : "") << "\n";
+
+	for (const auto& [name, stats] : result.counters)
+	{
+		os << "    " << std::left << std::setw(52) << name << std::right << std::setw(12) << std::setprecision(4)
+		   << stats.median << "\n";
+	}
+}
+
+inline std::string jsonEscape(const std::string& text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\') escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+inline void writeJsonStatistics(std::ostream& os, const Statistics& stats)
+{
+	os << "{\"min\": " << stats.min << ", \"max\": " << stats.max << ", \"mean\": " << stats.mean
+	   << ", \"median\": " << stats.median << ", \"stddev\": " << stats.stddev << ", \"p90\": " << stats.p90
+	   << ", \"p99\": " << stats.p99 << "}";
+}
+
+inline void writeJson(std::ostream& os, const std::vector<Result>& results, const Options& options)
+{
+	const std::time_t now = std::time(nullptr);
+	char date[32];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	os << std::setprecision(10);
+	os << "{\n  \"context\": {\"date\": \"" << date << "\", \"num_cpus\": " << std::thread::hardware_concurrency()
+	   << ", \"repetitions\": " << options.repetitions << ", \"warmup\": " << options.warmup
+	   << ", \"min_time\": " << options.minTime << "},\n  \"benchmarks\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& result = results[i];
+		os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << jsonEscape(result.name) << "\", \"args\": [";
+		for (size_t a = 0; a < result.args.size(); a++) os << (a == 0 ? "" : ", ") << result.args[a];
+		os << "], \"iterations\": " << result.iterations << ", \"repetitions\": " << result.repetitions
+		   << ", \"time_unit\": \"ns\", \"time\": ";
+		writeJsonStatistics(os, result.timeNs);
+		os << ", \"items_per_second\": " << result.itemsPerSecond << ", \"counters\": {";
+
+		bool first = true;
+		for (const auto& [name, stats] : result.counters)
+		{
+			os << (first ? "" : ", ") << "\"" << jsonEscape(name) << "\": ";
+			writeJsonStatistics(os, stats);
+			first = false;
+		}
+		os << "}}";
+	}
+	os << "\n  ]\n}\n";
+}
+
+inline void writeCsv(std::ostream& os, const std::vector<Result>& results)
+{
+	// Counters become additional columns holding the median over all repetitions
+	std::vector<std::string> counterNames;
+	for (const Result& result : results)
+	{
+		for (const auto& [name, stats] : result.counters)
+		{
+			if (std::find(counterNames.begin(), counterNames.end(), name) == counterNames.end())
+				counterNames.push_back(name);
+		}
+	}
+
+	os << std::setprecision(10);
+	os << "name,iterations,repetitions,min_ns,median_ns,mean_ns,p90_ns,p99_ns,max_ns,stddev_ns,items_per_second";
+	for (const std::string& name : counterNames) os << "," << name;
+	os << "\n";
+
+	for (const Result& result : results)
+	{
+		const Statistics& t = result.timeNs;
+		os << "\"" << result.name << "\"," << result.iterations << "," << result.repetitions << "," << t.min << ","
+		   << t.median << "," << t.mean << "," << t.p90 << "," << t.p99 << "," << t.max << "," << t.stddev << ","
+		   << result.itemsPerSecond;
+		for (const std::string& name : counterNames)
+		{
+			os << ",";
+			if (auto it = result.counters.find(name); it != result.counters.end()) os << it->second.median;
+		}
+		os << "\n";
+	}
+}
+
+inline int runBenchmarks(int argc, char* argv[])
+{
+	const Options options = parseOptions(argc, argv);
+	const std::regex filter(options.filter);
+
+	std::unique_ptr<PerfCounters> perf;
+	if (options.perfCounters && !options.list)
+	{
+		perf = std::make_unique<PerfCounters>();
+		if (!perf->available())
+		{
+			std::cerr << "Hardware performance counters are not available, reporting wall-clock time only\n";
+			perf.reset();
+		}
+	}
+
+	// Machine readable output goes to stdout unless a file is given, in which case the console report is kept
+	const bool printConsole = options.format == "console" || !options.out.empty();
+
+	std::vector<Result> results;
+	if (printConsole && !options.list) printConsoleHeader(std::cout);
+
+	for (const auto& benchmark : benchmarks())
+	{
+		std::vector<std::vector<int64_t>> argSets = benchmark->argSets();
+		if (argSets.empty()) argSets.push_back({});
+
+		for (const auto& args : argSets)
+		{
+			const std::string name = benchmark->fullName(args);
+			if (!std::regex_search(name, filter)) continue;
+
+			if (options.list)
+			{
+				std::cout << name << "\n";
+				continue;
+			}
+
+			results.push_back(runBenchmark(*benchmark, args, options, perf.get()));
+			if (printConsole) printConsoleResult(std::cout, results.back());
+		}
+	}
+
+	if (options.list || options.format == "console") return 0;
+
+	std::ofstream file;
+	if (!options.out.empty())
+	{
+		file.open(options.out);
+		if (!file)
+		{
+			std::cerr << "Could not open " << options.out << " for writing\n";
+			return 1;
+		}
+	}
+	std::ostream& os = options.out.empty() ? std::cout : file;
+
+	if (options.format == "json")
+		writeJson(os, results, options);
+	else
+		writeCsv(os, results);
+	return 0;
+}
+
+}  // namespace Bench
+
+#define EASYS_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define EASYS_BENCHMARK_CONCAT(a, b) EASYS_BENCHMARK_CONCAT_IMPL(a, b)
+
+#define EASYS_BENCHMARK(fn) \
+	static ::Bench::Benchmark* EASYS_BENCHMARK_CONCAT(easysBenchmark_, __LINE__) = ::Bench::registerBenchmark(#fn, fn)
+
+#define EASYS_BENCHMARK_MAIN()                                           \
+	int main(int argc, char* argv[]) { return ::Bench::runBenchmarks(argc, argv); } \
+	static_assert(true, "")
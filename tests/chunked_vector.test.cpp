@@ -0,0 +1,132 @@
+#include <catch2/catch.hpp>
+#include <easys/chunked_vector.hpp>
+#include <easys/ecs.hpp>
+#include <stdexcept>
+#include <string>
+
+// Counts live instances and throws on the copy selected by throwOnCopy
+struct CopyCounter {
+	static inline int alive = 0;
+	static inline int throwOnCopy = -1;
+	static inline int copies = 0;
+
+	CopyCounter() { alive++; }
+	CopyCounter(const CopyCounter&)
+	{
+		if (copies++ == throwOnCopy) throw std::runtime_error("copy failed");
+		alive++;
+	}
+	~CopyCounter() { alive--; }
+};
+
+struct ChunkedComponent {
+	int value;
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, ChunkedComponent> {
+	using type = Easys::ChunkedSparseSet<Key, ChunkedComponent, 4>;
+};
+
+TEST_CASE("ChunkedVector functionality", "[ChunkedVector]")
+{
+	Easys::ChunkedVector<std::string, 4> vec;
+
+	SECTION("Initially empty")
+	{
+		REQUIRE(vec.size() == 0);
+		REQUIRE(vec.capacity() == 0);
+	}
+
+	SECTION("push_back and access across chunks")
+	{
+		for (int i = 0; i < 10; i++) vec.push_back(std::to_string(i));
+
+		REQUIRE(vec.size() == 10);
+		REQUIRE(vec.capacity() == 12);
+		REQUIRE(vec[0] == "0");
+		REQUIRE(vec[9] == "9");
+		REQUIRE(vec.back() == "9");
+	}
+
+	SECTION("Element addresses are stable on growth")
+	{
+		vec.push_back("first");
+		const std::string* first = &vec[0];
+		for (int i = 0; i < 100; i++) vec.push_back(std::to_string(i));
+		REQUIRE(&vec[0] == first);
+		REQUIRE(*first == "first");
+	}
+
+	SECTION("pop_back, reserve and shrink_to_fit")
+	{
+		vec.reserve(9);
+		REQUIRE(vec.capacity() == 12);
+		for (int i = 0; i < 9; i++) vec.push_back(std::to_string(i));
+		for (int i = 0; i < 5; i++) vec.pop_back();
+		REQUIRE(vec.size() == 4);
+		vec.shrink_to_fit();
+		REQUIRE(vec.capacity() == 4);
+		REQUIRE(vec.back() == "3");
+	}
+
+	SECTION("Copy and move")
+	{
+		for (int i = 0; i < 6; i++) vec.push_back(std::to_string(i));
+		Easys::ChunkedVector<std::string, 4> copy = vec;
+		Easys::ChunkedVector<std::string, 4> moved = std::move(vec);
+		REQUIRE(copy.size() == 6);
+		REQUIRE(copy[5] == "5");
+		REQUIRE(moved.size() == 6);
+		REQUIRE(moved[5] == "5");
+	}
+
+	SECTION("A throwing copy destroys the elements copied so far")
+	{
+		{
+			using Counters = Easys::ChunkedVector<CopyCounter, 4>;
+			Counters counters;
+			for (int i = 0; i < 6; i++) counters.push_back(CopyCounter());
+			CopyCounter::copies = 0;
+			CopyCounter::throwOnCopy = 5;
+			REQUIRE_THROWS_AS(Counters(counters), std::runtime_error);
+			REQUIRE(CopyCounter::alive == 6);
+			CopyCounter::throwOnCopy = -1;
+		}
+		REQUIRE(CopyCounter::alive == 0);
+	}
+}
+
+TEST_CASE("ECS with chunked component storage", "[ChunkedVector]")
+{
+	Easys::ECS<ChunkedComponent> ecs;
+
+	SECTION("References survive insertion of further components")
+	{
+		Easys::Entity first = ecs.addEntity();
+		ecs.addComponent(first, ChunkedComponent{1});
+		ChunkedComponent& ref = ecs.getComponent<ChunkedComponent>(first);
+
+		for (int i = 0; i < 100; i++) ecs.addComponent(ecs.addEntity(), ChunkedComponent{i});
+
+		REQUIRE(&ref == &ecs.getComponent<ChunkedComponent>(first));
+		REQUIRE(ref.value == 1);
+	}
+
+	SECTION("Removal swaps from the last chunk")
+	{
+		std::vector<Easys::Entity> entities;
+		for (int i = 0; i < 10; i++)
+		{
+			entities.push_back(ecs.addEntity());
+			ecs.addComponent(entities.back(), ChunkedComponent{i});
+		}
+
+		ecs.removeComponent<ChunkedComponent>(entities[0]);
+
+		REQUIRE(ecs.getComponentCount<ChunkedComponent>() == 9);
+		REQUIRE_FALSE(ecs.hasComponent<ChunkedComponent>(entities[0]));
+		REQUIRE(ecs.getComponent<ChunkedComponent>(entities[9]).value == 9);
+		REQUIRE(ecs.getEntitiesByComponent<ChunkedComponent>()[0] == entities[9]);
+	}
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Measures the cost of instantiating the ECS for many component types: compiles ecs.compile_time.cpp for several
+// component counts and reports the median compile time, the object file size and the number of defined symbols.
+//
+// Usage: compile_benchmark [--counts=16,64,256] [--repetitions=3]
+//
+// The compiler, flags and paths are set by CMake when the target is configured.
+
+namespace {
+
+std::string quote(const std::string& s) { return "\"" + s + "\""; }
+
+// Number of symbols defined in the object file, or -1 if nm is not available
+long countSymbols(const std::filesystem::path& object)
+{
+	const std::string nm = EASYS_NM;
+	if (nm.empty()) return -1;
+
+	FILE* pipe = popen((quote(nm) + " --defined-only " + quote(object.string()) + " 2>/dev/null").c_str(), "r");
+	if (!pipe) return -1;
+
+	long lines = 0;
+	for (int c = std::fgetc(pipe); c != EOF; c = std::fgetc(pipe))
+	{
+		if (c == '\n') lines++;
+	}
+	return pclose(pipe) == 0 ? lines : -1;
+}
+
+std::vector<int> parseCounts(const std::string& list)
+{
+	std::vector<int> counts;
+	std::stringstream stream(list);
+	for (std::string item; std::getline(stream, item, ',');) counts.push_back(std::stoi(item));
+	return counts;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+	std::vector<int> counts = {16, 64, 256};
+	int repetitions = 3;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		if (arg.rfind("--counts=", 0) == 0)
+		{
+			counts = parseCounts(arg.substr(9));
+		} else if (arg.rfind("--repetitions=", 0) == 0)
+		{
+			repetitions = std::max(1, std::stoi(arg.substr(14)));
+		} else
+		{
+			std::cout << "Usage: " << argv[0] << " [--counts=16,64,256] [--repetitions=3]\n";
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+
+	const std::filesystem::path outputDir = EASYS_OUTPUT_DIR;
+	std::filesystem::create_directories(outputDir);
+
+	std::cout << std::left << std::setw(12) << "Components" << std::right << std::setw(14) << "Compile time"
+	          << std::setw(16) << "Object size" << std::setw(12) << "Symbols" << "\n"
+	          << std::string(54, '-') << "\n";
+
+	for (const int count : counts)
+	{
+		const std::filesystem::path object = outputDir / ("ecs.compile_time." + std::to_string(count) + ".o");
+		const std::string command = quote(EASYS_CXX_COMPILER) + " " + EASYS_CXX_FLAGS + " -I" +
+		                            quote(EASYS_INCLUDE_DIR) + " -DEASYS_COMPONENT_COUNT=" + std::to_string(count) +
+		                            " -c " + quote(EASYS_COMPILE_TIME_SOURCE) + " -o " + quote(object.string());
+
+		std::vector<double> seconds;
+		for (int r = 0; r < repetitions; r++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			if (std::system(command.c_str()) != 0)
+			{
+				std::cerr << "Compilation failed: " << command << "\n";
+				return 1;
+			}
+			seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		std::sort(seconds.begin(), seconds.end());
+
+		const long symbols = countSymbols(object);
+		std::cout << std::left << std::setw(12) << count << std::right << std::fixed << std::setprecision(2)
+		          << std::setw(13) << seconds[seconds.size() / 2] << "s" << std::setw(13)
+		          << std::filesystem::file_size(object) / 1024 << " KiB" << std::setw(12)
+		          << (symbols >= 0 ? std::to_string(symbols) : "n/a") << "\n";
+	}
+	return 0;
+}
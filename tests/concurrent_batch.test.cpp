@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <easys/concurrent_batch.hpp>
+#include <easys/ecs.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct StreamedMesh {
+	std::string name;
+};
+
+struct StreamedTransform {
+	float x = 0.0f;
+};
+
+}  // namespace
+
+TEST_CASE("ConcurrentAppendBuffer functionality", "[ConcurrentBatch]")
+{
+	Easys::ConcurrentAppendBuffer<std::string> buffer(1000);
+
+	SECTION("Appends from several threads")
+	{
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++)
+		{
+			threads.emplace_back(
+			    [&buffer, t]
+			    {
+				    for (int i = 0; i < 250; i++) buffer.emplace(std::to_string(t * 1000 + i));
+			    });
+		}
+		for (auto& thread : threads) thread.join();
+
+		std::vector<int> values;
+		buffer.forEach([&values](std::string& value) { values.push_back(std::stoi(value)); });
+		std::sort(values.begin(), values.end());
+		REQUIRE(buffer.size() == 1000);
+		REQUIRE(std::adjacent_find(values.begin(), values.end()) == values.end());
+		REQUIRE(values.front() == 0);
+		REQUIRE(values.back() == 3249);
+	}
+
+	SECTION("Throws once the capacity is exhausted")
+	{
+		for (int i = 0; i < 1000; i++) buffer.emplace("value");
+		REQUIRE_THROWS_AS(buffer.emplace("value"), std::length_error);
+		REQUIRE(buffer.size() == 1000);
+
+		buffer.clear();
+		REQUIRE(buffer.size() == 0);
+		buffer.emplace("again");
+		REQUIRE(buffer.size() == 1);
+	}
+}
+
+TEST_CASE("ECS concurrent insertion", "[ECS][ConcurrentBatch]")
+{
+	Easys::ECS<StreamedMesh, StreamedTransform> ecs;
+	const auto existing = ecs.addEntity();
+	ecs.addComponent(existing, StreamedTransform{1.0f});
+
+	SECTION("Producers fill a batch while the ECS is iterated")
+	{
+		auto batch = ecs.beginConcurrentInsert<StreamedMesh, StreamedTransform>(400);
+
+		std::atomic<bool> done = false;
+		std::vector<std::thread> producers;
+		for (int t = 0; t < 4; t++)
+		{
+			producers.emplace_back(
+			    [&batch, t]
+			    {
+				    for (int i = 0; i < 100; i++)
+				    {
+					    const auto e = batch.addEntity();
+					    batch.addComponent(e, StreamedMesh{"mesh" + std::to_string(t)});
+					    batch.addComponent(e, StreamedTransform{static_cast<float>(i)});
+				    }
+			    });
+		}
+		std::thread simulation(
+		    [&]
+		    {
+			    while (!done)
+			    {
+				    ecs.forEach<StreamedTransform>([](Easys::Entity, StreamedTransform& t) { t.x += 1.0f; });
+			    }
+		    });
+		for (auto& producer : producers) producer.join();
+		done = true;
+		simulation.join();
+
+		REQUIRE(ecs.getEntityCount() == 1);
+		ecs.commit(batch);
+
+		REQUIRE(ecs.getEntityCount() == 401);
+		REQUIRE(ecs.getComponentCount<StreamedMesh>() == 400);
+		REQUIRE(ecs.getComponentCount<StreamedTransform>() == 401);
+		REQUIRE(ecs.getEntitiesByComponents<StreamedMesh, StreamedTransform>().size() == 400);
+		REQUIRE(batch.usedEntities().empty());
+	}
+
+	SECTION("Unused IDs are released and removed entities are skipped")
+	{
+		auto batch = ecs.beginConcurrentInsert<StreamedTransform>(3);
+		const auto a = batch.addEntity();
+		batch.addComponent(a, StreamedTransform{2.0f});
+		batch.addComponent(existing, StreamedTransform{3.0f});
+		ecs.removeEntity(existing);
+
+		ecs.commit(batch);
+
+		REQUIRE(ecs.getEntityCount() == 1);
+		REQUIRE(ecs.getComponentCount<StreamedTransform>() == 1);
+		REQUIRE(ecs.getComponent<StreamedTransform>(a).x == 2.0f);
+		REQUIRE(ecs.memoryStats().entities.availableIds == Easys::MAX_ENTITIES - 1);
+	}
+
+	SECTION("Batches reserve their IDs up front")
+	{
+		auto batch = ecs.beginConcurrentInsert<StreamedMesh>(2);
+		const auto a = batch.addEntity();
+		const auto b = ecs.addEntity();
+		const auto c = batch.addEntity();
+
+		REQUIRE(a != b);
+		REQUIRE(c != b);
+		REQUIRE_THROWS_AS(batch.addEntity(), std::length_error);
+		REQUIRE_THROWS_AS(ecs.beginConcurrentInsert<StreamedMesh>(Easys::MAX_ENTITIES), std::runtime_error);
+
+		ecs.commit(batch);
+		REQUIRE(ecs.getEntityCount() == 4);
+	}
+
+	SECTION("Batches cannot be committed after the ECS was cleared")
+	{
+		auto batch = ecs.beginConcurrentInsert<StreamedMesh>(2);
+		batch.addEntity();
+		ecs.clear();
+		ecs.addEntity();  // may reuse an ID reserved by the batch
+
+		REQUIRE_THROWS_AS(ecs.commit(batch), std::logic_error);
+		REQUIRE(ecs.getEntityCount() == 1);
+	}
+}
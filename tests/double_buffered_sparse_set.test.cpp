@@ -0,0 +1,155 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <easys/double_buffered_sparse_set.hpp>
+#include <easys/ecs.hpp>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BufferedPosition {
+	float x;
+};
+
+struct BufferedVelocity {
+	float x;
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, BufferedPosition> {
+	using type = Easys::DoubleBufferedSparseSet<Key, BufferedPosition>;
+};
+
+TEST_CASE("DoubleBufferedSparseSet functionality", "[DoubleBufferedSparseSet]")
+{
+	Easys::DoubleBufferedSparseSet<uint32_t, std::string> set;
+
+	SECTION("New values are set in both buffers")
+	{
+		set.set(1, "a");
+		REQUIRE(set.get(1) == "a");
+		REQUIRE(set.getFront(1) == "a");
+	}
+
+	SECTION("Writes go to the back buffer until the buffers are swapped")
+	{
+		set.set(1, "a");
+		set.set(1, "b");
+		set[1] += "c";
+		REQUIRE(set.getFront(1) == "a");
+
+		set.swapBuffers();
+		REQUIRE(set.getFront(1) == "bc");
+		REQUIRE(set.get(1) == "a");
+	}
+
+	SECTION("Removal keeps both buffers in sync")
+	{
+		for (uint32_t i = 0; i < 5; i++) set.set(i, "front" + std::to_string(i));
+		set.swapBuffers();
+		for (uint32_t i = 0; i < 5; i++) set.set(i, "back" + std::to_string(i));
+
+		set.remove(1);
+		const std::vector<uint32_t> removed = {0, 3};
+		set.remove(removed, true);
+
+		REQUIRE(set.size() == 2);
+		std::map<uint32_t, std::string> front;
+		set.forEachFront([&front](uint32_t key, const std::string& value) { front[key] = value; });
+		REQUIRE(front == std::map<uint32_t, std::string>{{2, "front2"}, {4, "front4"}});
+		REQUIRE(set.get(2) == "back2");
+		REQUIRE(set.get(4) == "back4");
+		REQUIRE(set.tryGet(1) == nullptr);
+	}
+
+	SECTION("Sorting and reordering keep both buffers in sync")
+	{
+		for (uint32_t i = 0; i < 5; i++) set.set(i, "front" + std::to_string(i));
+		set.swapBuffers();
+		for (uint32_t i = 0; i < 5; i++) set.set(i, "back" + std::to_string(4 - i));
+
+		set.sort([](const std::string& a, const std::string& b) { return a < b; });
+		REQUIRE(set.getKeys() == std::vector<uint32_t>{4, 3, 2, 1, 0});
+		for (uint32_t i = 0; i < 5; i++) REQUIRE(set.getFront(i) == "front" + std::to_string(i));
+
+		const std::vector<uint32_t> order = {2, 0};
+		set.reorder(order);
+		REQUIRE(set.getKeys() == std::vector<uint32_t>{2, 0, 4, 3, 1});
+		for (uint32_t i = 0; i < 5; i++)
+		{
+			REQUIRE(set.getFront(i) == "front" + std::to_string(i));
+			REQUIRE(set.get(i) == "back" + std::to_string(4 - i));
+		}
+	}
+
+	SECTION("The buffers are separate arrays")
+	{
+		for (uint32_t i = 0; i < 64; i++) set.set(i, "value");
+		const auto back = reinterpret_cast<uintptr_t>(&set.get(0));
+		const auto front = reinterpret_cast<uintptr_t>(&set.getFront(0));
+		REQUIRE((front < back ? back - front : front - back) >= 64 * sizeof(std::string));
+	}
+}
+
+TEST_CASE("ECS double buffered components", "[ECS][DoubleBufferedSparseSet]")
+{
+	Easys::ECS<BufferedPosition, BufferedVelocity> ecs;
+	std::vector<Easys::Entity> entities;
+	for (int i = 0; i < 4; i++)
+	{
+		const auto e = ecs.addEntity();
+		ecs.addComponent(e, BufferedPosition{0.0f});
+		ecs.addComponent(e, BufferedVelocity{static_cast<float>(i)});
+		entities.push_back(e);
+	}
+
+	const auto simulate = [&ecs]
+	{
+		ecs.forEach<BufferedPosition, const BufferedVelocity>(
+		    [&ecs](Easys::Entity e, BufferedPosition& p, const BufferedVelocity& v)
+		    { p.x = ecs.getFrontComponent<BufferedPosition>(e).x + v.x; });
+	};
+
+	SECTION("Readers see the last published tick")
+	{
+		simulate();
+		REQUIRE(ecs.getFrontComponent<BufferedPosition>(entities[3]).x == 0.0f);
+
+		ecs.swapBuffers<BufferedPosition>();
+		REQUIRE(ecs.getFrontComponent<BufferedPosition>(entities[3]).x == 3.0f);
+
+		simulate();
+		ecs.swapBuffers<BufferedPosition>();
+		REQUIRE(ecs.getFrontComponent<BufferedPosition>(entities[3]).x == 6.0f);
+		REQUIRE(ecs.getComponent<BufferedPosition>(entities[3]).x == 3.0f);
+	}
+
+	SECTION("Rendering overlaps with the simulation")
+	{
+		for (int tick = 0; tick < 50; tick++)
+		{
+			float rendered = 0.0f;
+			std::thread render(
+			    [&]
+			    {
+				    ecs.forEachFront<BufferedPosition>([&](Easys::Entity, const BufferedPosition& p) { rendered += p.x; });
+			    });
+			simulate();
+			render.join();
+
+			REQUIRE(rendered == static_cast<float>(tick * 6));
+			ecs.swapBuffers<BufferedPosition>();
+		}
+	}
+
+	SECTION("Removing entities removes both buffers")
+	{
+		ecs.removeEntity(entities[0]);
+		ecs.swapBuffers<BufferedPosition>();
+
+		size_t visited = 0;
+		ecs.forEachFront<BufferedPosition>([&visited](Easys::Entity, const BufferedPosition&) { visited++; });
+		REQUIRE(visited == 3);
+		REQUIRE(ecs.getComponentCount<BufferedPosition>() == 3);
+	}
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <easys/dynamic_sparse_set.hpp>
+#include <stdexcept>
+#include <string>
+
+using namespace Easys;
+
+namespace {
+
+// An int whose copy hook throws on demand and which counts its live instances, to catch leaks and double destroys
+struct Fallible {
+	static inline int live = 0;
+	static inline bool throwOnCopy = false;
+
+	static ComponentDescriptor descriptor()
+	{
+		ComponentDescriptor descriptor{"Fallible", sizeof(int), alignof(int)};
+		descriptor.construct = [](void* dst)
+		{
+			*static_cast<int*>(dst) = 0;
+			live++;
+		};
+		descriptor.copy = [](void* dst, const void* src)
+		{
+			if (throwOnCopy) throw std::runtime_error("copy failed");
+			*static_cast<int*>(dst) = *static_cast<const int*>(src);
+			live++;
+		};
+		descriptor.destroy = [](void*) { live--; };
+		return descriptor;
+	}
+};
+
+}  // namespace
+
+TEST_CASE("DynamicSparseSet with a trivial layout", "[DynamicSparseSet]")
+{
+	// A script-defined struct { float x; float y; } described only by its layout
+	DynamicSparseSet<unsigned int> set(ComponentDescriptor{"Vec2", 2 * sizeof(float), alignof(float)});
+
+	SECTION("Values are zero-initialized by default")
+	{
+		auto* value = static_cast<float*>(set.set(5));
+		REQUIRE(value[0] == 0.0f);
+		REQUIRE(value[1] == 0.0f);
+		REQUIRE(set.contains(5));
+		REQUIRE(set.size() == 1);
+	}
+
+	SECTION("Values are copied and survive reallocation")
+	{
+		for (unsigned int i = 0; i < 100; i++)
+		{
+			const float value[2] = {static_cast<float>(i), static_cast<float>(2 * i)};
+			set.set(i, value);
+		}
+		REQUIRE(set.size() == 100);
+		REQUIRE(static_cast<const float*>(set.get(42))[1] == 84.0f);
+		REQUIRE(set.capacity() >= 100);
+	}
+
+	SECTION("Removal moves the last value into the hole")
+	{
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			const float value[2] = {static_cast<float>(i), 0.0f};
+			set.set(i, value);
+		}
+		set.remove(0);
+		REQUIRE_FALSE(set.contains(0));
+		REQUIRE(set.getKeys() == std::vector<unsigned int>{2, 1});
+		REQUIRE(static_cast<const float*>(set.get(2))[0] == 2.0f);
+		REQUIRE(set.tryGet(0) == nullptr);
+#if EASYS_CHECKED
+		REQUIRE_THROWS_AS(set.get(0), KeyNotFoundException);
+#endif
+	}
+
+	SECTION("Copying a value of the same set while it grows")
+	{
+		const float value[2] = {1.0f, 2.0f};
+		for (unsigned int i = 0; i < 8; i++) set.set(i, value);
+		REQUIRE(set.size() == set.capacity());
+		set.set(8, set.get(3));
+		REQUIRE(static_cast<const float*>(set.get(8))[1] == 2.0f);
+	}
+
+	SECTION("Memory statistics use the aligned stride")
+	{
+		set.set(0);
+		set.set(1);
+		REQUIRE(set.memoryStats().valuesUsed == 2 * 2 * sizeof(float));
+		set.shrinkToFit();
+		REQUIRE(set.capacity() == 2);
+	}
+
+	SECTION("Copies hold their own values")
+	{
+		const float value[2] = {1.0f, 2.0f};
+		set.set(4, value);
+		DynamicSparseSet<unsigned int> copy = set;
+		static_cast<float*>(copy.get(4))[0] = 3.0f;
+
+		REQUIRE(copy.getKeys() == set.getKeys());
+		REQUIRE(static_cast<const float*>(set.get(4))[0] == 1.0f);
+		REQUIRE(static_cast<const float*>(copy.get(4))[0] == 3.0f);
+	}
+}
+
+TEST_CASE("DynamicSparseSet with lifetime hooks", "[DynamicSparseSet]")
+{
+	DynamicSparseSet<unsigned int> set(ComponentDescriptor::of<std::string>("Name"));
+
+	SECTION("Values are constructed, copied, moved and destroyed")
+	{
+		const std::string name = "a name that does not fit into the small string buffer";
+		for (unsigned int i = 0; i < 20; i++) set.set(i, &name);
+		set.remove(3);
+		REQUIRE(*static_cast<const std::string*>(set.get(19)) == name);
+		REQUIRE(static_cast<const std::string*>(set.set(30))->empty());
+
+		set.clear();
+		REQUIRE(set.size() == 0);
+	}
+
+	SECTION("Copies are deep")
+	{
+		const std::string name = "a name that does not fit into the small string buffer";
+		for (unsigned int i = 0; i < 3; i++) set.set(i, &name);
+		DynamicSparseSet<unsigned int> copy(ComponentDescriptor::of<std::string>("Name"));
+		copy = set;
+		*static_cast<std::string*>(set.get(1)) = "changed";
+
+		REQUIRE(copy.size() == 3);
+		REQUIRE(*static_cast<const std::string*>(copy.get(1)) == name);
+	}
+
+	SECTION("Values without a move hook are copied and destroyed")
+	{
+		ComponentDescriptor descriptor = ComponentDescriptor::of<std::string>("Name");
+		descriptor.move = nullptr;
+		DynamicSparseSet<unsigned int> copyOnly(descriptor);
+
+		const std::string name = "a name that does not fit into the small string buffer";
+		for (unsigned int i = 0; i < 20; i++) copyOnly.set(i, &name);
+		copyOnly.remove(3);
+		REQUIRE(*static_cast<const std::string*>(copyOnly.get(19)) == name);
+		REQUIRE(*static_cast<const std::string*>(copyOnly.get(0)) == name);
+	}
+
+	SECTION("A throwing copy hook leaves the set unchanged")
+	{
+		{
+			DynamicSparseSet<unsigned int> fallible(Fallible::descriptor());
+			for (int i = 0; i < 8; i++) fallible.set(static_cast<unsigned int>(i), &i);
+
+			Fallible::throwOnCopy = true;
+			const int value = 42;
+			REQUIRE_THROWS_AS(fallible.set(3, &value), std::runtime_error);  // replaces an existing value
+			REQUIRE_THROWS_AS(fallible.set(8, &value), std::runtime_error);  // grows the buffer, copying every value
+			Fallible::throwOnCopy = false;
+
+			REQUIRE(fallible.size() == 8);
+			REQUIRE(fallible.capacity() == 8);
+			REQUIRE(*static_cast<const int*>(fallible.get(3)) == 3);
+			REQUIRE(*static_cast<const int*>(fallible.get(7)) == 7);
+			REQUIRE(Fallible::live == 8);
+		}
+		REQUIRE(Fallible::live == 0);
+	}
+
+	SECTION("Alignment must be a power of two")
+	{
+		REQUIRE_THROWS_AS(DynamicSparseSet<unsigned int>(ComponentDescriptor{"Broken", 4, 3}), std::invalid_argument);
+	}
+}
@@ -4,9 +4,12 @@
 
 #include <catch2/catch.hpp>
 #include <chrono>
+#include <cstdlib>
 #include <easys/ecs.hpp>
 #include <easys/entity.hpp>
 
+#include "perf_counters.hpp"
+
 #define NUM_ENT Easys::MAX_ENTITIES  // number of entities
 #define NUM_COM 1                    // number of components per entity
 #define COMPTYPES Position, RigidBody, Data, Health, Damage, TestComponent, AnotherComponent
@@ -73,11 +76,22 @@ std::string formatEntCompInfo(const std::string functionName, const int numEntit
 	return oss.str();
 }
 
+// Set EASYS_PERF_COUNTERS=1 to additionally report hardware performance counters per entity for each section.
+bool perfCountersEnabled()
+{
+	const char* value = std::getenv("EASYS_PERF_COUNTERS");
+	return value != nullptr && std::string(value) != "0";
+}
+
 // This function is a helper to run benchmarks. It  that takes a lambda function as an argument.
 // This lambda function will contain the code to benchmark.
 template <typename Func>
 void benchmarkSection(Func func, const std::string& sectionName)
 {
+	std::unique_ptr<Bench::PerfCounters> perf;
+	if (perfCountersEnabled()) perf = std::make_unique<Bench::PerfCounters>();
+	if (perf) perf->start();
+
 	auto start = std::chrono::high_resolution_clock::now();
 
 	func();  // Execute the lambda function
@@ -85,8 +99,18 @@ void benchmarkSection(Func func, const std::string& sectionName)
 	auto end = std::chrono::high_resolution_clock::now();
 	std::chrono::duration<double, std::milli> elapsed = end - start;
 
+	std::string counters;
+	if (perf)
+	{
+		perf->stop();
+		for (const auto& [name, value] : perf->read())
+		{
+			counters += ", " + name + "/e: " + std::to_string(value / static_cast<double>(NUM_ENT));
+		}
+	}
+
 	// CAPTURE(sectionName, elapsed.count());
-	SUCCEED("Benchmark completed for " + sectionName + ": " + std::to_string(elapsed.count()) + " ms");
+	SUCCEED("Benchmark completed for " + sectionName + ": " + std::to_string(elapsed.count()) + " ms" + counters);
 }
 
 TEST_CASE("ECS Benchmark", "[ECS]")
@@ -133,6 +157,27 @@ TEST_CASE("ECS Benchmark", "[ECS]")
 		    formatEntCompInfo("removeEntity", NUM_ENT, NUM_COM));
 	}
 
+	SECTION("Benchmarking Batched Component Removal")
+	{
+		ECS ecs;
+		TestComponent c = TestComponent{};
+		std::vector<Entity> entities;
+
+		for (int i = 0; i < NUM_ENT; i++)
+		{
+			Entity e = ecs.addEntity();
+			ecs.addComponent<TestComponent>(e, c);
+			if (i % 2 == 0) entities.push_back(e);
+		}
+
+		benchmarkSection(
+		    [&]
+		    {
+			    ecs.removeComponents<TestComponent>(entities);
+		    },
+		    formatEntCompInfo("removeComponents (every 2nd)", NUM_ENT, NUM_COM));
+	}
+
 	SECTION("Benchmarking Component Addition")
 	{
 		ECS ecs;
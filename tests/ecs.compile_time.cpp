@@ -0,0 +1,49 @@
+#include <easys/ecs.hpp>
+#include <easys/entity.hpp>
+#include <utility>
+
+// The translation unit measured by the compile_benchmark target. It instantiates the public ECS API for
+// EASYS_COMPONENT_COUNT component types, similar to a game that registers all of its components in one world.
+
+#ifndef EASYS_COMPONENT_COUNT
+#define EASYS_COMPONENT_COUNT 16
+#endif
+
+template <size_t N>
+struct Component {
+	float value;
+};
+
+template <size_t... Is>
+Easys::ECS<Component<Is>...> makeECS(std::index_sequence<Is...>);
+
+using ECS = decltype(makeECS(std::make_index_sequence<EASYS_COMPONENT_COUNT>{}));
+
+template <size_t... Is>
+float useAllComponents(ECS& ecs, Easys::Entity e, std::index_sequence<Is...>)
+{
+	(ecs.addComponent(e, Component<Is>{static_cast<float>(Is)}), ...);
+	float sum = (ecs.getComponent<Component<Is>>(e).value + ...);
+	sum += ((ecs.hasComponent<Component<Is>>(e) ? 1.0f : 0.0f) + ...);
+	sum += static_cast<float>((ecs.getComponentCount<Component<Is>>() + ...));
+	(ecs.removeComponent<Component<Is>>(e), ...);
+	return sum;
+}
+
+float run()
+{
+	ECS ecs;
+	Easys::Entity e = ecs.addEntity();
+	float sum = useAllComponents(ecs, e, std::make_index_sequence<EASYS_COMPONENT_COUNT>{});
+
+	ecs.forEach<Component<0>, Component<EASYS_COMPONENT_COUNT - 1>>([&](Easys::Entity, auto& a, auto& b)
+	                                                                 { sum += a.value + b.value; });
+	sum += static_cast<float>(ecs.getEntitiesByComponents<Component<0>, Component<1>>().size());
+	sum += static_cast<float>(ecs.memoryStats().totalBytes());
+	ecs.removeEntity(e);
+	ecs.shrinkToFit();
+	ecs.clear();
+	return sum;
+}
+
+int main() { return run() > 0.0f ? 0 : 1; }
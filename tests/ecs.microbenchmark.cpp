@@ -0,0 +1,620 @@
+#define EASYS_ENTITY_LIMIT 1000000
+
+#include <algorithm>
+#include <array>
+#include <easys/ecs.hpp>
+#include <easys/entity.hpp>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+
+// Microbenchmarks for the add/remove/get/iterate paths of the ECS. Run with --help to see the available flags, e.g.
+// `microbenchmarks --filter=GetComponent --format=json --out=results.json`.
+
+template <size_t N>
+struct Component {
+	float x, y, z, w;
+};
+
+using ECS = Easys::ECS<Component<0>,
+                       Component<1>,
+                       Component<2>,
+                       Component<3>,
+                       Component<4>,
+                       Component<5>,
+                       Component<6>,
+                       Component<7>>;
+using Entity = Easys::Entity;
+
+struct Position {
+	float x, y;
+};
+
+struct PositionOf {
+	std::array<float, 2> operator()(const Position& p) const { return {p.x, p.y}; }
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, Position> {
+	using type = Easys::SpatialSparseSet<Key, Position, PositionOf>;
+};
+
+static const std::vector<int64_t> entityCounts = {1000, 10000, 100000, 1000000};
+static const std::vector<int64_t> componentCounts = {1, 2, 4, 8};
+
+// Adds the first `count` component types to an entity
+template <size_t... Is>
+void addComponents(ECS& ecs, Entity e, size_t count, std::index_sequence<Is...>)
+{
+	((Is < count ? ecs.addComponent(e, Component<Is>{}) : void()), ...);
+}
+
+void populate(ECS& ecs, int64_t entities, size_t components)
+{
+	for (int64_t i = 0; i < entities; i++)
+	{
+		addComponents(ecs, ecs.addEntity(), components, std::make_index_sequence<8>{});
+	}
+}
+
+void BM_AddEntity(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		state.resumeTiming();
+
+		for (int64_t i = 0; i < n; i++) Bench::doNotOptimize(ecs->addEntity());
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_AddEntity)->argName("entities")->args(entityCounts);
+
+// Creating and destroying a world with a few entities, e.g. one world per match on a game server
+void BM_CreateWorld(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	for (auto _ : state)
+	{
+		ECS ecs;
+		populate(ecs, n, 2);
+		Bench::doNotOptimize(ecs);
+	}
+	state.setItemsProcessed(state.iterations());
+}
+EASYS_BENCHMARK(BM_CreateWorld)->argName("entities")->args({0, 10, 100});
+
+void BM_RemoveEntity(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t c = static_cast<size_t>(state.range(1));
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		populate(*ecs, n, c);
+		state.resumeTiming();
+
+		for (int64_t i = 0; i < n; i++) ecs->removeEntity(static_cast<Entity>(i));
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_RemoveEntity)->argNames({"entities", "components"})->argsProduct({entityCounts, componentCounts});
+
+void BM_RemoveEntities(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t c = static_cast<size_t>(state.range(1));
+	std::vector<Entity> entities(n);
+	for (int64_t i = 0; i < n; i++) entities[i] = static_cast<Entity>(i);
+
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		populate(*ecs, n, c);
+		state.resumeTiming();
+
+		ecs->removeEntities(entities);
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_RemoveEntities)->argNames({"entities", "components"})->argsProduct({entityCounts, componentCounts});
+
+void BM_AddComponent(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t c = static_cast<size_t>(state.range(1));
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		for (int64_t i = 0; i < n; i++) ecs->addEntity();
+		state.resumeTiming();
+
+		for (int64_t i = 0; i < n; i++)
+		{
+			addComponents(*ecs, static_cast<Entity>(i), c, std::make_index_sequence<8>{});
+		}
+	}
+	state.setItemsProcessed(state.iterations() * n * c);
+}
+EASYS_BENCHMARK(BM_AddComponent)->argNames({"entities", "components"})->argsProduct({entityCounts, componentCounts});
+
+void BM_AddComponentReserved(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		for (int64_t i = 0; i < n; i++) ecs->addEntity();
+		ecs->reserve<Component<0>>(n);
+		ecs->reserveEntities(n);
+		state.resumeTiming();
+
+		for (int64_t i = 0; i < n; i++) ecs->addComponent(static_cast<Entity>(i), Component<0>{});
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_AddComponentReserved)->argName("entities")->args(entityCounts);
+
+// Spawning a wave of identical entities with 8 components each, the baseline for BM_Instantiate
+void BM_SpawnIndividually(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		state.resumeTiming();
+
+		populate(*ecs, n, 8);
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_SpawnIndividually)->argName("entities")->args(entityCounts);
+
+void BM_Instantiate(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const Easys::Prefab prefab(Component<0>{},
+	                           Component<1>{},
+	                           Component<2>{},
+	                           Component<3>{},
+	                           Component<4>{},
+	                           Component<5>{},
+	                           Component<6>{},
+	                           Component<7>{});
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		state.resumeTiming();
+
+		Bench::doNotOptimize(ecs->instantiate(prefab, n).data());
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_Instantiate)->argName("entities")->args(entityCounts);
+
+void BM_RemoveComponent(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		populate(*ecs, n, 1);
+		state.resumeTiming();
+
+		for (int64_t i = 0; i < n; i++) ecs->removeComponent<Component<0>>(static_cast<Entity>(i));
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_RemoveComponent)->argName("entities")->args(entityCounts);
+
+void BM_RemoveComponents(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::vector<Entity> entities;
+	for (int64_t i = 0; i < n; i += 2) entities.push_back(static_cast<Entity>(i));
+
+	std::optional<ECS> ecs;  // destroyed while the timer is paused
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		ecs.emplace();
+		populate(*ecs, n, 1);
+		state.resumeTiming();
+
+		ecs->removeComponents<Component<0>>(entities);
+	}
+	state.setItemsProcessed(state.iterations() * entities.size());
+}
+EASYS_BENCHMARK(BM_RemoveComponents)->argName("entities")->args(entityCounts);
+
+void BM_GetComponent(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	ECS ecs;
+	populate(ecs, n, 1);
+
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < n; i++) Bench::doNotOptimize(ecs.getComponent<Component<0>>(static_cast<Entity>(i)));
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_GetComponent)->argName("entities")->args(entityCounts);
+
+void BM_TryGetComponent(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	ECS ecs;
+	populate(ecs, n, 1);
+
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < n; i++) Bench::doNotOptimize(ecs.tryGetComponent<Component<0>>(static_cast<Entity>(i)));
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_TryGetComponent)->argName("entities")->args(entityCounts);
+
+// A component type owned by every 16th entity, looked up for random entities, e.g. a system asking whether an entity
+// is a light source. The sparse array spans all entity IDs, the compact variant stores its slots as uint16_t.
+struct RareComponent {
+	float intensity;
+};
+
+struct CompactRareComponent {
+	float intensity;
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, CompactRareComponent> {
+	using type = Easys::CompactSparseSet<Key, CompactRareComponent, 65535>;
+};
+
+template <typename T>
+void tryGetRare(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	Easys::ECS<T> ecs;
+	for (int64_t i = 0; i < n; i++)
+	{
+		const Entity e = ecs.addEntity();
+		if (i % 16 == 0) ecs.addComponent(e, T{1.0f});
+	}
+	std::vector<Entity> lookups(static_cast<size_t>(n));
+	std::iota(lookups.begin(), lookups.end(), Entity{0});
+	std::shuffle(lookups.begin(), lookups.end(), std::mt19937(42));
+
+	for (auto _ : state)
+	{
+		float sum = 0.0f;
+		for (const Entity e : lookups)
+		{
+			if (const T* c = ecs.template tryGetComponent<T>(e)) sum += c->intensity;
+		}
+		Bench::doNotOptimize(sum);
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+
+void BM_TryGetRareComponent(Bench::State& state) { tryGetRare<RareComponent>(state); }
+EASYS_BENCHMARK(BM_TryGetRareComponent)->argName("entities")->args(entityCounts);
+
+void BM_TryGetRareComponentCompact(Bench::State& state) { tryGetRare<CompactRareComponent>(state); }
+EASYS_BENCHMARK(BM_TryGetRareComponentCompact)->argName("entities")->args(entityCounts);
+
+struct FrameTime {
+	float delta;
+};
+
+using WorldWithResources = Easys::ECS<Component<0>, FrameTime, Easys::Resources<FrameTime>>;
+
+// Global state attached to a dummy entity and read per entity by a system, the baseline for BM_ReadResource
+void BM_ReadSingletonComponent(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	WorldWithResources ecs;
+	for (int64_t i = 0; i < n; i++) ecs.addComponent(ecs.addEntity(), Component<0>{});
+	const Entity time = ecs.addEntity();
+	ecs.addComponent(time, FrameTime{0.016f});
+
+	for (auto _ : state)
+	{
+		ecs.forEach<Component<0>>([&](Entity, Component<0>& c) { c.x += ecs.getComponent<FrameTime>(time).delta; });
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_ReadSingletonComponent)->argName("entities")->args({1000, 10000, 100000});
+
+void BM_ReadResource(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	WorldWithResources ecs;
+	for (int64_t i = 0; i < n; i++) ecs.addComponent(ecs.addEntity(), Component<0>{});
+	ecs.setResource(FrameTime{0.016f});
+
+	for (auto _ : state)
+	{
+		ecs.forEach<Component<0>>([&](Entity, Component<0>& c) { c.x += ecs.resource<FrameTime>().delta; });
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_ReadResource)->argName("entities")->args({1000, 10000, 100000});
+
+void BM_GetComponentUnchecked(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	ECS ecs;
+	populate(ecs, n, 1);
+
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < n; i++)
+		{
+			Bench::doNotOptimize(ecs.getComponentUnchecked<Component<0>>(static_cast<Entity>(i)));
+		}
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_GetComponentUnchecked)->argName("entities")->args(entityCounts);
+
+void BM_HasComponent(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	ECS ecs;
+	// Only every second entity owns the component, so the branch is not trivially predictable
+	for (int64_t i = 0; i < n; i++)
+	{
+		Entity e = ecs.addEntity();
+		if (i % 2 == 0) ecs.addComponent(e, Component<0>{});
+	}
+
+	for (auto _ : state)
+	{
+		for (int64_t i = 0; i < n; i++) Bench::doNotOptimize(ecs.hasComponent<Component<0>>(static_cast<Entity>(i)));
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_HasComponent)->argName("entities")->args(entityCounts);
+
+void BM_Query(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t c = static_cast<size_t>(state.range(1));
+	ECS ecs;
+	populate(ecs, n, c);
+
+	for (auto _ : state)
+	{
+		Bench::doNotOptimize(ecs.getEntitiesByComponents<Component<0>, Component<1>>());
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_Query)->argNames({"entities", "components"})->argsProduct({entityCounts, {2, 4, 8}});
+
+// The access pattern of examples/simple_gameloop.cpp: query, then fetch two components per entity
+void BM_Iterate(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t c = static_cast<size_t>(state.range(1));
+	ECS ecs;
+	populate(ecs, n, c);
+	const std::vector<Entity> entities = ecs.getEntitiesByComponents<Component<0>, Component<1>>();
+
+	for (auto _ : state)
+	{
+		for (Entity e : entities)
+		{
+			auto& a = ecs.getComponent<Component<0>>(e);
+			const auto& b = ecs.getComponent<Component<1>>(e);
+			a.x += b.x;
+			a.y += b.y;
+		}
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * entities.size());
+}
+EASYS_BENCHMARK(BM_Iterate)->argNames({"entities", "components"})->argsProduct({entityCounts, {2, 4, 8}});
+
+// Walks two pools in tandem after Component<1> was added in random order, with and without sortAs() in between
+void iterateTandem(Bench::State& state, const bool sorted)
+{
+	const int64_t n = state.range(0);
+	ECS ecs;
+	std::vector<Entity> entities(static_cast<size_t>(n));
+	for (Entity& e : entities)
+	{
+		e = ecs.addEntity();
+		ecs.addComponent(e, Component<0>{});
+	}
+	std::shuffle(entities.begin(), entities.end(), std::mt19937(42));
+	for (const Entity e : entities) ecs.addComponent(e, Component<1>{1.0f, 1.0f, 1.0f, 1.0f});
+	if (sorted) ecs.sortAs<Component<0>, Component<1>>();
+
+	for (auto _ : state)
+	{
+		ecs.forEach<Component<0>, const Component<1>>(
+		    [](Entity, Component<0>& a, const Component<1>& b)
+		    {
+			    a.x += b.x;
+			    a.y += b.y;
+		    });
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+
+void BM_IterateShuffled(Bench::State& state) { iterateTandem(state, false); }
+EASYS_BENCHMARK(BM_IterateShuffled)->argName("entities")->args(entityCounts);
+
+void BM_IterateSortedAs(Bench::State& state) { iterateTandem(state, true); }
+EASYS_BENCHMARK(BM_IterateSortedAs)->argName("entities")->args(entityCounts);
+
+// forEach() walking one pool and looking up another in random order, the dependent sparse and value loads that
+// EASYS_PREFETCH_DISTANCE hides. The microbenchmarks_prefetch target runs the same code with prefetching enabled.
+static const std::vector<int64_t> lookupCounts = {1000, 100000, 1000000, 8000000};
+
+void BM_ForEachShuffled(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	ECS ecs(static_cast<Entity>(std::max<int64_t>(n, Easys::MAX_ENTITIES)));
+	std::vector<Entity> entities(static_cast<size_t>(n));
+	for (Entity& e : entities)
+	{
+		e = ecs.addEntity();
+		ecs.addComponent(e, Component<0>{});
+	}
+	std::shuffle(entities.begin(), entities.end(), std::mt19937(42));
+	for (const Entity e : entities) ecs.addComponent(e, Component<1>{1.0f, 1.0f, 1.0f, 1.0f});
+
+	for (auto _ : state)
+	{
+		float sum = 0.0f;
+		ecs.forEach<const Component<0>, const Component<1>>([&sum](Entity, const Component<0>&, const Component<1>& b)
+		                                                    { sum += b.x; });
+		Bench::doNotOptimize(sum);
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_ForEachShuffled)->argName("entities")->args(lookupCounts);
+
+void BM_Sort(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+	ECS ecs;
+	for (int64_t i = 0; i < n; i++) ecs.addComponent(ecs.addEntity(), Component<0>{value(rng), 0.0f, 0.0f, 0.0f});
+
+	for (auto _ : state)
+	{
+		state.pauseTiming();
+		for (const Entity e : ecs.getEntitiesByComponent<Component<0>>()) ecs.getComponent<Component<0>>(e).x = value(rng);
+		state.resumeTiming();
+
+		ecs.sort<Component<0>>([](const Component<0>& a, const Component<0>& b) { return a.x < b.x; });
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_Sort)->argName("entities")->args(entityCounts);
+
+struct BufferedTransform {
+	float x, y, z, w;
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, BufferedTransform> {
+	using type = Easys::DoubleBufferedSparseSet<Key, BufferedTransform>;
+};
+
+// Publishing a tick for a render thread by copying the pool into a snapshot, the baseline for BM_SwapBuffers
+void BM_SnapshotCopy(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	ECS ecs;
+	populate(ecs, n, 1);
+
+	std::vector<Component<0>> snapshot;
+	for (auto _ : state)
+	{
+		snapshot.clear();
+		ecs.forEach<const Component<0>>([&snapshot](Entity, const Component<0>& c) { snapshot.push_back(c); });
+		Bench::doNotOptimize(snapshot.data());
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_SnapshotCopy)->argName("entities")->args(entityCounts);
+
+void BM_SwapBuffers(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	Easys::ECS<BufferedTransform> ecs;
+	for (int64_t i = 0; i < n; i++) ecs.addComponent(ecs.addEntity(), BufferedTransform{});
+
+	for (auto _ : state)
+	{
+		ecs.swapBuffers<BufferedTransform>();
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_SwapBuffers)->argName("entities")->args(entityCounts);
+
+// Entities scattered uniformly over a 1000x1000 area, each query finds the neighbours within a radius of 10
+static constexpr float worldSize = 1000.0f;
+static constexpr float queryRadius = 10.0f;
+
+void scatter(Easys::ECS<Position, Component<0>>& ecs, int64_t entities, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> coordinate(0.0f, worldSize);
+	for (int64_t i = 0; i < entities; i++) ecs.addComponent(ecs.addEntity(), Position{coordinate(rng), coordinate(rng)});
+}
+
+void BM_QueryRadius(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> coordinate(0.0f, worldSize);
+	Easys::ECS<Position, Component<0>> ecs;
+	ecs.setSpatialCellSize<Position>(queryRadius);
+	scatter(ecs, n, rng);
+
+	std::vector<Entity> result;
+	for (auto _ : state)
+	{
+		ecs.queryRadius<Position>(coordinate(rng), coordinate(rng), queryRadius, result);
+		Bench::doNotOptimize(result.data());
+	}
+	state.setItemsProcessed(state.iterations());
+}
+EASYS_BENCHMARK(BM_QueryRadius)->argName("entities")->args(entityCounts);
+
+// The same query as BM_QueryRadius as a scan over all positions, the baseline without a spatial index
+void BM_QueryRadiusLinear(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> coordinate(0.0f, worldSize);
+	Easys::ECS<Position, Component<0>> ecs;
+	scatter(ecs, n, rng);
+
+	std::vector<Entity> result;
+	for (auto _ : state)
+	{
+		const float x = coordinate(rng), y = coordinate(rng);
+		result.clear();
+		ecs.forEach<Position>(
+		    [&](Entity e, const Position& p)
+		    {
+			    const float dx = p.x - x, dy = p.y - y;
+			    if (dx * dx + dy * dy <= queryRadius * queryRadius) result.push_back(e);
+		    });
+		Bench::doNotOptimize(result.data());
+	}
+	state.setItemsProcessed(state.iterations());
+}
+EASYS_BENCHMARK(BM_QueryRadiusLinear)->argName("entities")->args(entityCounts);
+
+EASYS_BENCHMARK_MAIN();
@@ -0,0 +1,327 @@
+#define EASYS_ENTITY_LIMIT 1000000
+
+#include <algorithm>
+#include <cmath>
+#include <easys/ecs.hpp>
+#include <easys/entity.hpp>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+
+// Scenario benchmarks modelled on the workloads of a running game rather than on single operations: entities that
+// are spawned and despawned every frame, component combinations that follow a skewed (Zipf) distribution, entity IDs
+// that are scattered after heavy recycling and several systems reading and writing different component types. All
+// scenarios use a fixed seed, so every run sees the same workload. Run with --help to see the available flags.
+
+template <size_t N>
+struct Component {
+	float x, y, z, w;
+};
+
+using ECS = Easys::ECS<Component<0>,
+                       Component<1>,
+                       Component<2>,
+                       Component<3>,
+                       Component<4>,
+                       Component<5>,
+                       Component<6>,
+                       Component<7>,
+                       Component<8>,
+                       Component<9>,
+                       Component<10>,
+                       Component<11>,
+                       Component<12>,
+                       Component<13>,
+                       Component<14>,
+                       Component<15>>;
+using Entity = Easys::Entity;
+
+static constexpr size_t componentTypes = 16;
+static const std::vector<int64_t> entityCounts = {1000, 10000, 100000};
+
+// Samples ranks in [0, n) where rank k is drawn with a probability proportional to 1 / (k + 1)^s
+class ZipfDistribution {
+   public:
+	ZipfDistribution(size_t n, double s) : cdf_(n)
+	{
+		double sum = 0.0;
+		for (size_t k = 0; k < n; k++) cdf_[k] = sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+		for (double& p : cdf_) p /= sum;
+	}
+
+	template <typename Rng>
+	size_t operator()(Rng& rng)
+	{
+		const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+		return std::min<size_t>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin(), cdf_.size() - 1);
+	}
+
+   private:
+	std::vector<double> cdf_;
+};
+
+// Adds the component types whose bit is set in `mask`
+template <size_t... Is>
+void addComponents(ECS& ecs, Entity e, uint32_t mask, std::index_sequence<Is...>)
+{
+	((mask & (1u << Is) ? ecs.addComponent(e, Component<Is>{1.0f, 1.0f, 1.0f, 1.0f}) : void()), ...);
+}
+
+// A component combination ("archetype") drawn from a Zipf distribution over 64 fixed masks: a few combinations are
+// very common and most are rare, like in a real game. Every combination contains at least one component.
+class ArchetypeSampler {
+   public:
+	explicit ArchetypeSampler(std::mt19937& rng) : zipf_(64, 1.1)
+	{
+		std::uniform_int_distribution<uint32_t> bits(1, (1u << componentTypes) - 1);
+		for (auto& mask : masks_) mask = bits(rng) | 1u;  // Component<0> acts as the transform of every entity
+	}
+
+	uint32_t operator()(std::mt19937& rng) { return masks_[zipf_(rng)]; }
+
+   private:
+	ZipfDistribution zipf_;
+	uint32_t masks_[64];
+};
+
+Entity spawn(ECS& ecs, ArchetypeSampler& archetypes, std::mt19937& rng)
+{
+	Entity e = ecs.addEntity();
+	addComponents(ecs, e, archetypes(rng), std::make_index_sequence<componentTypes>{});
+	return e;
+}
+
+// Reports how scattered the entity IDs of the transform pool are, see ECS::memoryStats()
+void reportFragmentation(Bench::State& state, const ECS& ecs)
+{
+	const auto stats = ecs.memoryStats();
+	state.counters["sparseFill"] = stats.components[0].pool.sparseFillRatio;
+	state.counters["MiB"] = static_cast<double>(stats.totalBytes()) / (1024.0 * 1024.0);
+}
+
+// Steady-state churn: every frame 5% of the population is despawned and the same number is spawned again, e.g.
+// projectiles and particles. Exercises entity ID recycling and the removal paths of all pools.
+void BM_Churn(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t perFrame = std::max<size_t>(1, static_cast<size_t>(n) / 20);
+
+	std::mt19937 rng(42);
+	ArchetypeSampler archetypes(rng);
+	ECS ecs;
+	std::vector<Entity> alive;
+	for (int64_t i = 0; i < n; i++) alive.push_back(spawn(ecs, archetypes, rng));
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < perFrame; i++)
+		{
+			const size_t index = std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng);
+			ecs.removeEntity(alive[index]);
+			alive[index] = alive.back();
+			alive.pop_back();
+		}
+		for (size_t i = 0; i < perFrame; i++) alive.push_back(spawn(ecs, archetypes, rng));
+	}
+	state.setItemsProcessed(state.iterations() * perFrame * 2);
+	reportFragmentation(state, ecs);
+}
+EASYS_BENCHMARK(BM_Churn)->argName("entities")->args(entityCounts);
+
+// Queries over a Zipf-distributed population: some queries match most entities, others only a handful, so the cost
+// of starting from the smallest pool and the cost of the ID list queries are visible.
+void BM_ZipfQueries(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+
+	std::mt19937 rng(42);
+	ArchetypeSampler archetypes(rng);
+	ECS ecs;
+	for (int64_t i = 0; i < n; i++) spawn(ecs, archetypes, rng);
+
+	size_t visited = 0;
+	for (auto _ : state)
+	{
+		ecs.forEach<Component<0>, Component<1>>(
+		    [&](Entity, auto& a, const auto& b)
+		    {
+			    a.x += b.x;
+			    visited++;
+		    });
+		ecs.forEach<Component<2>, Component<5>, Component<9>>(
+		    [&](Entity, auto& a, const auto& b, const auto& c)
+		    {
+			    a.y += b.y * c.y;
+			    visited++;
+		    });
+		ecs.forEach<Component<14>, Component<15>>(
+		    [&](Entity, auto& a, const auto& b)
+		    {
+			    a.z += b.z;
+			    visited++;
+		    });
+		visited += ecs.getEntitiesByComponents<Component<3>, Component<4>>().size();
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(static_cast<int64_t>(visited));
+}
+EASYS_BENCHMARK(BM_ZipfQueries)->argName("entities")->args(entityCounts);
+
+// Random access after heavy recycling: the population has been despawned and respawned several times, so the
+// surviving entities own IDs scattered across a much larger range and the sparse arrays are mostly empty.
+void BM_FragmentedAccess(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+
+	std::mt19937 rng(42);
+	ArchetypeSampler archetypes(rng);
+	ECS ecs;
+	std::vector<Entity> alive;
+	for (int64_t i = 0; i < n; i++) alive.push_back(spawn(ecs, archetypes, rng));
+	for (int round = 0; round < 4; round++)
+	{
+		std::shuffle(alive.begin(), alive.end(), rng);
+		for (size_t i = 0; i < alive.size() / 2; i++) ecs.removeEntity(alive[i]);
+		alive.erase(alive.begin(), alive.begin() + static_cast<std::ptrdiff_t>(alive.size() / 2));
+		while (alive.size() < static_cast<size_t>(n)) alive.push_back(spawn(ecs, archetypes, rng));
+	}
+	std::shuffle(alive.begin(), alive.end(), rng);
+
+	for (auto _ : state)
+	{
+		for (Entity e : alive)
+		{
+			auto& transform = ecs.getComponent<Component<0>>(e);
+			if (auto* velocity = ecs.tryGetComponent<Component<1>>(e)) transform.x += velocity->x;
+		}
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+	reportFragmentation(state, ecs);
+}
+EASYS_BENCHMARK(BM_FragmentedAccess)->argName("entities")->args(entityCounts);
+
+// A frame of a game loop: several systems that read and write different component types, followed by a small amount
+// of spawning and despawning.
+void BM_MixedSystems(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+	const size_t perFrame = std::max<size_t>(1, static_cast<size_t>(n) / 100);
+
+	std::mt19937 rng(42);
+	ArchetypeSampler archetypes(rng);
+	ECS ecs;
+	std::vector<Entity> alive;
+	for (int64_t i = 0; i < n; i++) alive.push_back(spawn(ecs, archetypes, rng));
+
+	for (auto _ : state)
+	{
+		ecs.runSystem("movement",
+		              [](ECS& world)
+		              {
+			              world.forEach<Component<0>, Component<1>>(
+			                  [](Entity, auto& transform, const auto& velocity)
+			                  {
+				                  transform.x += velocity.x;
+				                  transform.y += velocity.y;
+			                  });
+		              });
+		ecs.runSystem("physics",
+		              [](ECS& world)
+		              {
+			              world.forEach<Component<1>, Component<2>, Component<3>>(
+			                  [](Entity, auto& velocity, const auto& mass, const auto& force)
+			                  { velocity.x += force.x / (mass.x + 1.0f); });
+		              });
+		ecs.runSystem("animation",
+		              [](ECS& world)
+		              {
+			              world.forEach<Component<6>, Component<7>>([](Entity, auto& pose, const auto& clip)
+			                                                        { pose.w += clip.w; });
+		              });
+		ecs.runSystem("lifetime",
+		              [&](ECS& world)
+		              {
+			              for (size_t i = 0; i < perFrame; i++)
+			              {
+				              const size_t index = std::uniform_int_distribution<size_t>(0, alive.size() - 1)(rng);
+				              world.removeEntity(alive[index]);
+				              alive[index] = spawn(world, archetypes, rng);
+			              }
+		              });
+		ecs.endFrame();
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+EASYS_BENCHMARK(BM_MixedSystems)->argName("entities")->args(entityCounts);
+
+// Random access into a large world, e.g. a physics step visiting bodies in broadphase order. With 4 KiB pages every
+// access misses the TLB, the huge page variant stores the same pools in HugePageSparseSet. Compare the dTLB misses
+// with --perf-counters.
+struct LargeTransform {
+	float x, y, z, w;
+};
+
+struct LargeVelocity {
+	float x, y, z, w;
+};
+
+struct HugeTransform {
+	float x, y, z, w;
+};
+
+struct HugeVelocity {
+	float x, y, z, w;
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, HugeTransform> {
+	using type = Easys::HugePageSparseSet<Key, HugeTransform>;
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, HugeVelocity> {
+	using type = Easys::HugePageSparseSet<Key, HugeVelocity>;
+};
+
+template <typename Transform, typename Velocity>
+void largeWorldAccess(Bench::State& state)
+{
+	const int64_t n = state.range(0);
+
+	Easys::ECS<Transform, Velocity> ecs;
+	std::vector<Entity> order;
+	for (int64_t i = 0; i < n; i++)
+	{
+		const Entity e = ecs.addEntity();
+		ecs.addComponent(e, Transform{});
+		ecs.addComponent(e, Velocity{1.0f, 1.0f, 1.0f, 1.0f});
+		order.push_back(e);
+	}
+	std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+	for (auto _ : state)
+	{
+		for (const Entity e : order)
+		{
+			auto& transform = ecs.template getComponent<Transform>(e);
+			const auto& velocity = ecs.template getComponent<Velocity>(e);
+			transform.x += velocity.x;
+		}
+		Bench::clobberMemory();
+	}
+	state.setItemsProcessed(state.iterations() * n);
+}
+
+static const std::vector<int64_t> largeWorldCounts = {1000, 100000, 1000000};
+
+void BM_LargeWorldAccess(Bench::State& state) { largeWorldAccess<LargeTransform, LargeVelocity>(state); }
+EASYS_BENCHMARK(BM_LargeWorldAccess)->argName("entities")->args(largeWorldCounts);
+
+void BM_LargeWorldAccessHugePages(Bench::State& state) { largeWorldAccess<HugeTransform, HugeVelocity>(state); }
+EASYS_BENCHMARK(BM_LargeWorldAccessHugePages)->argName("entities")->args(largeWorldCounts);
+
+EASYS_BENCHMARK_MAIN();
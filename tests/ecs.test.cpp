@@ -2,6 +2,8 @@
 #include <easys/ecs.hpp>
 #include <easys/entity.hpp>
 #include <memory>
+#include <set>
+#include <string>
 
 using namespace Easys;
 
@@ -35,6 +37,58 @@ TEST_CASE("ECS Tests", "[ECS]")
 		REQUIRE(ecs.getEntities().find(entity) == ecs.getEntities().end());
 	}
 
+	SECTION("Remove Entities in a batch")
+	{
+		std::vector<Entity> entities;
+		for (int i = 0; i < 6; i++)
+		{
+			entities.push_back(ecs.addEntity());
+			ecs.addComponent<TestComponent>(entities.back(), TestComponent{i});
+			if (i % 2 == 0) ecs.addComponent<AnotherComponent>(entities.back(), AnotherComponent{1.0f * i});
+		}
+
+		ecs.removeEntities(std::vector<Entity>{entities[0], entities[3], entities[4]});
+
+		REQUIRE(ecs.getEntityCount() == 3);
+		REQUIRE_FALSE(ecs.hasEntity(entities[0]));
+		REQUIRE(ecs.getComponentCount<TestComponent>() == 3);
+		REQUIRE(ecs.getComponentCount<AnotherComponent>() == 1);
+		REQUIRE(ecs.getComponent<TestComponent>(entities[5]).data == 5);
+		REQUIRE(ecs.getComponent<AnotherComponent>(entities[2]).value == 2.0f);
+	}
+
+	SECTION("Remove Entities given by a component view")
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			Entity entity = ecs.addEntity();
+			ecs.addComponent<TestComponent>(entity, TestComponent{i});
+			if (i < 2) ecs.addComponent<AnotherComponent>(entity, AnotherComponent{});
+		}
+
+		ecs.removeEntities(ecs.getEntitiesByComponent<AnotherComponent>());
+
+		REQUIRE(ecs.getEntityCount() == 2);
+		REQUIRE(ecs.getComponentCount<AnotherComponent>() == 0);
+		REQUIRE(ecs.getComponentCount<TestComponent>() == 2);
+	}
+
+	SECTION("Remove Components in a batch preserving order")
+	{
+		std::vector<Entity> entities;
+		for (int i = 0; i < 5; i++)
+		{
+			entities.push_back(ecs.addEntity());
+			ecs.addComponent<TestComponent>(entities.back(), TestComponent{i});
+		}
+
+		ecs.removeComponents<TestComponent>(std::vector<Entity>{entities[1], entities[2]}, true);
+
+		REQUIRE(ecs.getEntityCount() == 5);
+		REQUIRE(ecs.getEntitiesByComponent<TestComponent>()
+		        == std::vector<Entity>{entities[0], entities[3], entities[4]});
+	}
+
 	SECTION("Has Component")
 	{
 		Entity entity = ecs.addEntity();
@@ -55,6 +109,20 @@ TEST_CASE("ECS Tests", "[ECS]")
 		REQUIRE(retrievedComp.data == 20);
 	}
 
+	SECTION("Try Get and Unchecked Get Component")
+	{
+		Entity entity = ecs.addEntity();
+		ecs.addComponent<TestComponent>(entity, TestComponent{25});
+
+		REQUIRE(ecs.tryGetComponent<TestComponent>(entity) != nullptr);
+		REQUIRE(ecs.tryGetComponent<TestComponent>(entity)->data == 25);
+		REQUIRE(ecs.tryGetComponent<AnotherComponent>(entity) == nullptr);
+
+		ecs.getComponentUnchecked<TestComponent>(entity).data = 26;
+		const auto& constEcs = ecs;
+		REQUIRE(constEcs.getComponentUnchecked<TestComponent>(entity).data == 26);
+	}
+
 	SECTION("Remove Component")
 	{
 		Entity entity = ecs.addEntity();
@@ -125,6 +193,58 @@ TEST_CASE("ECS Tests", "[ECS]")
 		// REQUIRE(ecs.getEntitiesByComponents<AnotherComponent, ForeignComponent>().size() == 0);
 	}
 
+	SECTION("forEach visits entities with all given components")
+	{
+		Entity entity1 = ecs.addEntity();
+		Entity entity2 = ecs.addEntity();
+		Entity entity3 = ecs.addEntity();
+		ecs.addComponent(entity1, TestComponent{1});
+		ecs.addComponent(entity2, TestComponent{2});
+		ecs.addComponent(entity2, AnotherComponent{2.0f});
+		ecs.addComponent(entity3, AnotherComponent{3.0f});
+
+		std::vector<Entity> visited;
+		ecs.forEach<TestComponent, AnotherComponent>(
+		    [&visited](Entity e, TestComponent& test, AnotherComponent& another)
+		    {
+			    visited.push_back(e);
+			    test.data *= 10;
+			    another.value = 0.0f;
+		    });
+
+		REQUIRE(visited == std::vector<Entity>{entity2});
+		REQUIRE(ecs.getComponent<TestComponent>(entity1).data == 1);
+		REQUIRE(ecs.getComponent<TestComponent>(entity2).data == 20);
+		REQUIRE(ecs.getComponent<AnotherComponent>(entity2).value == 0.0f);
+
+		int sum = 0;
+		ecs.forEach<TestComponent>(
+		    [&sum](Entity, const TestComponent& test)
+		    {
+			    sum += test.data;
+		    });
+		REQUIRE(sum == 21);
+	}
+
+	SECTION("runSystem calls the system with the ECS")
+	{
+		Entity entity = ecs.addEntity();
+		ecs.addComponent(entity, TestComponent{1});
+
+		ecs.runSystem("increment",
+		              [](auto& world)
+		              {
+			              world.template forEach<TestComponent>(
+			                  [](Entity, TestComponent& test)
+			                  {
+				                  test.data++;
+			                  });
+		              });
+		ecs.endFrame();
+
+		REQUIRE(ecs.getComponent<TestComponent>(entity).data == 2);
+	}
+
 	SECTION("getEntityCount returns correct number of entities", "[ECS]")
 	{
 		ECS<ECS_TEST_COMPTYPES> ecs;
@@ -188,4 +308,205 @@ TEST_CASE("ECS Tests", "[ECS]")
 		REQUIRE(ecs.addEntity() == 0);  // Check if all entity IDs are available again
 		REQUIRE(ecs.getComponentCount<TestComponent, AnotherComponent>() == 0);
 	}
-}
\ No newline at end of file
+
+	SECTION("Entity IDs are handed out lazily in queue order")
+	{
+		ECS<ECS_TEST_COMPTYPES> ecs;
+		REQUIRE(ecs.memoryStats().entities.availableIds == MAX_ENTITIES);
+		REQUIRE(ecs.addEntity() == 0);
+		REQUIRE(ecs.addEntity() == 1);
+		ecs.removeEntity(0);
+		ecs.removeEntity(0);  // removing twice must not free the ID twice
+		REQUIRE(ecs.addEntity() == 2);  // released IDs are reused after all unused ones
+
+		ECS<ECS_TEST_COMPTYPES> restored(std::set<Entity>{1, 3});
+		REQUIRE(restored.getEntityCount() == 2);
+		REQUIRE(restored.addEntity() == 0);
+		REQUIRE(restored.addEntity() == 2);
+		REQUIRE(restored.addEntity() == 4);
+		REQUIRE(restored.memoryStats().entities.availableIds == MAX_ENTITIES - 5);
+	}
+
+	SECTION("Worlds can have their own entity limit")
+	{
+		ECS<ECS_TEST_COMPTYPES> small(Entity{3});
+		REQUIRE(small.getEntityLimit() == 3);
+		for (int i = 0; i < 3; i++) small.addEntity();
+		REQUIRE_THROWS_AS(small.addEntity(), std::runtime_error);
+		REQUIRE(ecs.getEntityLimit() == MAX_ENTITIES);
+
+		ECS<ECS_TEST_COMPTYPES> restored(std::set<Entity>{1, 7}, 5);
+		REQUIRE(restored.getEntityCount() == 1);
+		REQUIRE(restored.memoryStats().entities.availableIds == 4);
+	}
+
+	SECTION("Released IDs are reused oldest first")
+	{
+		ECS<ECS_TEST_COMPTYPES> full(Entity{8});
+		for (int i = 0; i < 8; i++) full.addEntity();
+
+		// Interleave releases and reuses, so that the queue of released IDs wraps and compacts several times
+		std::vector<Entity> expected;
+		for (Entity e = 0; e < 8; e++)
+		{
+			full.removeEntity(e);
+			expected.push_back(e);
+		}
+		for (int round = 0; round < 50; round++)
+		{
+			const Entity reused = full.addEntity();
+			REQUIRE(reused == expected.front());
+			expected.erase(expected.begin());
+			full.removeEntity(reused);
+			expected.push_back(reused);
+		}
+		REQUIRE(full.memoryStats().entities.availableIds == 8);
+	}
+
+	SECTION("Sort a pool and order another pool like it")
+	{
+		const std::vector<int> data = {3, 1, 4, 1, 5};
+		for (int i = 0; i < 5; i++)
+		{
+			const Entity e = ecs.addEntity();
+			ecs.addComponent(e, TestComponent{data[i]});
+			ecs.addComponent(e, AnotherComponent{static_cast<float>(i)});
+		}
+		const Entity onlyAnother = ecs.addEntity();
+		ecs.addComponent(onlyAnother, AnotherComponent{-1.0f});
+
+		ecs.sort<TestComponent>([](const TestComponent& a, const TestComponent& b) { return a.data > b.data; });
+		REQUIRE(ecs.getEntitiesByComponent<TestComponent>() == std::vector<Entity>{4, 2, 0, 1, 3});
+
+		ecs.sortAs<TestComponent, AnotherComponent>();
+		REQUIRE(ecs.getEntitiesByComponent<AnotherComponent>() == std::vector<Entity>{4, 2, 0, 1, 3, onlyAnother});
+		for (Entity e = 0; e < 5; e++)
+		{
+			REQUIRE(ecs.getComponent<TestComponent>(e).data == data[e]);
+			REQUIRE(ecs.getComponent<AnotherComponent>(e).value == static_cast<float>(e));
+		}
+	}
+
+	SECTION("Hierarchy order and subtree removal")
+	{
+		ECS<ECS_TEST_COMPTYPES> ecs;
+		std::vector<Entity> entities;
+		for (int i = 0; i < 5; i++)
+		{
+			entities.push_back(ecs.addEntity());
+			ecs.addComponent<TestComponent>(entities.back(), TestComponent{i});
+		}
+		// 4 -> 2 -> 0, 4 -> 1, 3 stays a root
+		ecs.setParent(0, 2);
+		ecs.setParent(2, 4);
+		ecs.setParent(1, 4);
+		REQUIRE(ecs.getParent(0) == 2);
+
+		ecs.sortByHierarchy<TestComponent>();
+		const auto& order = ecs.getEntitiesByComponent<TestComponent>();
+		auto position = [&order](Entity e) { return std::find(order.begin(), order.end(), e) - order.begin(); };
+		REQUIRE(position(4) < position(2));
+		REQUIRE(position(2) < position(0));
+		REQUIRE(position(4) < position(1));
+		REQUIRE(ecs.getComponent<TestComponent>(2).data == 2);
+
+		ecs.removeSubtree(2);
+		REQUIRE_FALSE(ecs.hasEntity(0));
+		REQUIRE_FALSE(ecs.hasEntity(2));
+		REQUIRE(ecs.getEntityCount() == 3);
+		REQUIRE(ecs.getComponentCount<TestComponent>() == 3);
+
+		std::vector<Entity> children;
+		ecs.forEachChild(4, [&children](Entity e) { children.push_back(e); });
+		REQUIRE(children == std::vector<Entity>{1});
+
+		ecs.removeEntity(4);
+		REQUIRE(ecs.getParent(1) == NULL_ENTITY);
+	}
+
+	SECTION("Reserving and shrinking component pools")
+	{
+		ECS<ECS_TEST_COMPTYPES> ecs;
+		ecs.reserve<TestComponent>(128);
+		ecs.reserveEntities(128);
+		REQUIRE(ecs.getComponentCapacity<TestComponent>() >= 128);
+		REQUIRE(ecs.getComponentCapacity<AnotherComponent>() == 0);
+
+		auto entity = ecs.addEntity();
+		ecs.addComponent<TestComponent>(entity, TestComponent{7});
+		ecs.shrinkToFit<TestComponent>();
+		REQUIRE(ecs.getComponentCapacity<TestComponent>() == 1);
+		REQUIRE(ecs.getComponent<TestComponent>(entity).data == 7);
+
+		ecs.shrinkToFit();
+		REQUIRE(ecs.getComponentCount() == 1);
+	}
+
+	SECTION("Runtime component types coexist with static ones")
+	{
+		ECS<ECS_TEST_COMPTYPES> ecs;
+		const ComponentId health = ecs.registerComponent(ComponentDescriptor{"Health", sizeof(int), alignof(int)});
+		REQUIRE(ecs.findComponent("Health") == health);
+		REQUIRE_FALSE(ecs.findComponent("Mana").has_value());
+		REQUIRE_THROWS_AS(ecs.registerComponent(ComponentDescriptor{"Health", 4, 4}), std::invalid_argument);
+
+		auto a = ecs.addEntity();
+		auto b = ecs.addEntity();
+		const int hp = 100;
+		ecs.addComponent(a, health, &hp);
+		ecs.addComponent(b, health);
+		ecs.addComponent<TestComponent>(a, TestComponent{1});
+		REQUIRE(ecs.hasComponent(b, health));
+		REQUIRE(*static_cast<int*>(ecs.getComponent(a, health)) == 100);
+		REQUIRE(ecs.getComponentCount(health) == 2);
+		REQUIRE(ecs.getComponentCount() == 3);
+
+		const ComponentId ids[] = {health};
+		int visited = 0;
+		ecs.forEach<TestComponent>(ids,
+		                           [&](Entity e, TestComponent& test, std::span<void* const> dynamic)
+		                           {
+			                           REQUIRE(e == a);
+			                           *static_cast<int*>(dynamic[0]) += test.data;
+			                           visited++;
+		                           });
+		REQUIRE(visited == 1);
+		REQUIRE(*static_cast<int*>(ecs.getComponent(a, health)) == 101);
+
+		ecs.removeEntity(a);
+		REQUIRE(ecs.tryGetComponent(a, health) == nullptr);
+		REQUIRE(ecs.getEntitiesByComponent(health) == std::vector<Entity>{b});
+		REQUIRE(std::string(ecs.memoryStats().components.back().name) == "Health");
+
+		ecs.removeComponent(b, health);
+		REQUIRE(ecs.getComponentCount(health) == 0);
+	}
+
+	SECTION("memoryStats reports every component pool")
+	{
+		ECS<ECS_TEST_COMPTYPES> ecs;
+		auto entity = ecs.addEntity();
+		auto child = ecs.addEntity();
+		ecs.addComponent<TestComponent>(entity, TestComponent{1});
+
+		auto stats = ecs.memoryStats();
+		REQUIRE(stats.components.size() == 2);
+		REQUIRE(std::string(stats.components[0].name).find("TestComponent") != std::string::npos);
+		REQUIRE(stats.components[0].count == 1);
+		REQUIRE(stats.components[0].pool.valuesUsed == sizeof(TestComponent));
+		REQUIRE(stats.components[1].count == 0);
+		REQUIRE(stats.components[1].pool.used() == 0);
+		REQUIRE(stats.entities.activeEntities == 2);
+		REQUIRE(stats.entities.availableIds == MAX_ENTITIES - 2);
+		REQUIRE(stats.entities.bytes > 0);
+		REQUIRE(stats.hierarchy.used() == 0);
+		REQUIRE(stats.totalBytes() >= stats.componentBytesUsed());
+
+		// Parent/child links are reported on their own, not as part of the entity bookkeeping
+		ecs.setParent(child, entity);
+		const auto linked = ecs.memoryStats();
+		REQUIRE(linked.entities.bytes == stats.entities.bytes);
+		REQUIRE(linked.hierarchy.used() > 0);
+		REQUIRE(linked.totalBytes() >= linked.entities.bytes + linked.hierarchy.reserved());
+	}
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+#include <easys/hierarchy.hpp>
+#include <vector>
+
+using namespace Easys;
+
+TEST_CASE("Hierarchy Tests", "[Hierarchy]")
+{
+	// 0
+	// ├── 1
+	// │   └── 3
+	// └── 2
+	Hierarchy hierarchy;
+	hierarchy.setParent(2, 0);
+	hierarchy.setParent(1, 0);
+	hierarchy.setParent(3, 1);
+
+	auto depthFirst = [&hierarchy](Entity root)
+	{
+		std::vector<Entity> visited;
+		hierarchy.forEachDepthFirst(root, [&visited](Entity e) { visited.push_back(e); });
+		return visited;
+	};
+
+	SECTION("Links")
+	{
+		REQUIRE(hierarchy.getParent(3) == 1);
+		REQUIRE(hierarchy.getParent(0) == NULL_ENTITY);
+		REQUIRE(hierarchy.getFirstChild(0) == 1);  // new children are inserted in front
+		REQUIRE(hierarchy.getNextSibling(1) == 2);
+		REQUIRE(hierarchy.size() == 4);
+	}
+
+	SECTION("Depth-first and breadth-first traversal")
+	{
+		REQUIRE(depthFirst(0) == std::vector<Entity>{0, 1, 3, 2});
+		REQUIRE(depthFirst(1) == std::vector<Entity>{1, 3});
+		REQUIRE(depthFirst(7) == std::vector<Entity>{7});
+
+		std::vector<Entity> visited;
+		hierarchy.forEachBreadthFirst(0, [&visited](Entity e) { visited.push_back(e); });
+		REQUIRE(visited == std::vector<Entity>{0, 1, 2, 3});
+	}
+
+	SECTION("Reparenting moves the whole subtree")
+	{
+		hierarchy.setParent(1, 2);
+		REQUIRE(depthFirst(0) == std::vector<Entity>{0, 2, 1, 3});
+		REQUIRE_THROWS_AS(hierarchy.setParent(0, 3), std::invalid_argument);
+		REQUIRE_THROWS_AS(hierarchy.setParent(0, 0), std::invalid_argument);
+	}
+
+	SECTION("Detaching and removing")
+	{
+		hierarchy.detach(1);
+		REQUIRE(hierarchy.getParent(1) == NULL_ENTITY);
+		REQUIRE(depthFirst(0) == std::vector<Entity>{0, 2});
+		REQUIRE(depthFirst(1) == std::vector<Entity>{1, 3});
+
+		hierarchy.remove(1);
+		REQUIRE(hierarchy.getParent(3) == NULL_ENTITY);
+		REQUIRE(hierarchy.size() == 2);  // only 0 and 2 are still related
+
+		hierarchy.remove(0);
+		REQUIRE(hierarchy.size() == 0);
+	}
+
+	SECTION("Depth-first order of all trees")
+	{
+		hierarchy.setParent(5, 4);
+		const std::vector<Entity> order = hierarchy.depthFirstOrder();
+		REQUIRE(order.size() == 6);
+		auto position = [&order](Entity e) { return std::find(order.begin(), order.end(), e) - order.begin(); };
+		REQUIRE(position(0) < position(1));
+		REQUIRE(position(1) < position(3));
+		REQUIRE(position(4) < position(5));
+	}
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <easys/ecs.hpp>
+#include <easys/huge_page_allocator.hpp>
+#include <vector>
+
+namespace {
+
+struct HugeTransform {
+	float x, y, z, w;
+};
+
+}  // namespace
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, HugeTransform> {
+	using type =
+	    Easys::HugePageSparseSet<Key, HugeTransform, Easys::HugePages::Transparent, Easys::NumaPlacement::Local>;
+};
+
+TEST_CASE("HugePageAllocator", "[HugePageAllocator]")
+{
+	SECTION("Small and large allocations are usable")
+	{
+		Easys::HugePageAllocator<uint64_t> allocator;
+		for (const size_t n : {size_t{1}, size_t{1000}, size_t{1} << 20, (size_t{3} << 20) + 7})
+		{
+			uint64_t* values = allocator.allocate(n);
+			for (size_t i = 0; i < n; i++) values[i] = i;
+			REQUIRE(values[n - 1] == n - 1);
+#if defined(__linux__)
+			if (n * sizeof(uint64_t) >= allocator.hugePageSize)
+			{
+				REQUIRE(reinterpret_cast<uintptr_t>(values) % allocator.hugePageSize == 0);
+			}
+#endif
+			allocator.deallocate(values, n);
+		}
+	}
+
+	SECTION("Explicit huge pages and NUMA placement fall back gracefully")
+	{
+		std::vector<int, Easys::HugePageAllocator<int, Easys::HugePages::Explicit, Easys::NumaPlacement::Interleave>>
+		    values;
+		for (int i = 0; i < 2'000'000; i++) values.push_back(i);
+		values.shrink_to_fit();
+		REQUIRE(values[1'999'999] == 1'999'999);
+	}
+
+	SECTION("Pools can be backed by huge pages")
+	{
+		Easys::ECS<HugeTransform> ecs(Easys::Entity{200'000});  // a world larger than EASYS_ENTITY_LIMIT
+		for (int i = 0; i < 200'000; i++) ecs.addComponent(ecs.addEntity(), HugeTransform{static_cast<float>(i), 0.0f, 0.0f, 0.0f});
+		ecs.removeEntity(0);
+
+		REQUIRE(ecs.getComponentCount<HugeTransform>() == 199'999);
+		REQUIRE(ecs.getComponent<HugeTransform>(1234).x == 1234.0f);
+		REQUIRE(ecs.getComponentCapacity<HugeTransform>() * sizeof(HugeTransform) >= size_t{2} << 20);
+	}
+}
@@ -0,0 +1,63 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <easys/ecs.hpp>
+#include <easys/job_system.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace Easys;
+
+TEST_CASE("JobSystem runs submitted jobs", "[JobSystem]")
+{
+	for (const size_t workers : {0, 1, 3})
+	{
+		JobSystem jobs(workers);
+		REQUIRE(jobs.workerCount() == workers);
+
+		std::atomic<int> counter = 0;
+		for (int i = 0; i < 100; i++) jobs.submit([&counter] { counter++; });
+		jobs.wait();
+		REQUIRE(counter == 100);
+
+		// Jobs may submit further jobs
+		jobs.submit([&] { jobs.submit([&counter] { counter++; }); });
+		jobs.wait();
+		REQUIRE(counter == 101);
+	}
+}
+
+TEST_CASE("JobSystem rethrows exceptions from jobs", "[JobSystem]")
+{
+	JobSystem jobs(2);
+	std::atomic<int> counter = 0;
+	jobs.submit([] { throw std::runtime_error("job failed"); });
+	for (int i = 0; i < 10; i++) jobs.submit([&counter] { counter++; });
+
+	REQUIRE_THROWS_AS(jobs.wait(), std::runtime_error);
+	REQUIRE(counter == 10);
+	REQUIRE_NOTHROW(jobs.wait());
+}
+
+TEST_CASE("JobSystem updates independent worlds", "[JobSystem]")
+{
+	struct Counter {
+		int value;
+	};
+
+	std::vector<ECS<Counter>> worlds(16);
+	for (auto& world : worlds)
+	{
+		for (int i = 0; i < 10; i++) world.addComponent(world.addEntity(), Counter{0});
+	}
+
+	JobSystem jobs(2);
+	for (int frame = 0; frame < 5; frame++)
+	{
+		jobs.forEach(worlds, [](ECS<Counter>& world) { world.forEach<Counter>([](Entity, Counter& c) { c.value++; }); });
+	}
+
+	for (const auto& world : worlds)
+	{
+		REQUIRE(world.getComponent<Counter>(9).value == 5);
+	}
+}
@@ -1,5 +1,18 @@
 #define CATCH_CONFIG_MAIN
 
+#include "chunked_vector.test.cpp"
+#include "concurrent_batch.test.cpp"
+#include "double_buffered_sparse_set.test.cpp"
+#include "dynamic_sparse_set.test.cpp"
 #include "ecs.test.cpp"
+#include "hierarchy.test.cpp"
+#include "huge_page_allocator.test.cpp"
+#include "job_system.test.cpp"
+#include "pool_access.test.cpp"
+#include "prefab.test.cpp"
+#include "profiler.test.cpp"
 #include "registry.test.cpp"
+#include "resource.test.cpp"
 #include "sparse_set.test.cpp"
+#include "spatial_index.test.cpp"
+#include "task.test.cpp"
@@ -0,0 +1,129 @@
+#pragma once
+
+// Hardware performance counters for the benchmarks, based on Linux perf_event_open(2). Counting is restricted to
+// user space, so it works with the default perf_event_paranoid setting of 2. On other platforms, or when the kernel
+// does not allow access (e.g. in containers), no counters are available and the benchmarks report wall-clock time
+// only.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Bench {
+
+class PerfCounters {
+   public:
+	struct Reading {
+		std::string name;
+		double value;
+	};
+
+	PerfCounters()
+	{
+#if defined(__linux__)
+		constexpr auto cache = [](uint64_t cacheId, uint64_t op, uint64_t result)
+		{
+			return cacheId | (op << 8) | (result << 16);
+		};
+
+		open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+		open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+		open("branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+		open("L1d-misses",
+		     PERF_TYPE_HW_CACHE,
+		     cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+		open("LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+		open("dTLB-misses",
+		     PERF_TYPE_HW_CACHE,
+		     cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+		// A software event, available even on virtual machines without a PMU
+		open("page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	~PerfCounters()
+	{
+#if defined(__linux__)
+		for (const auto& counter : counters_) close(counter.fd);
+#endif
+	}
+
+	bool available() const { return !counters_.empty(); }
+
+	// Reset all counters to zero
+	void reset()
+	{
+#if defined(__linux__)
+		for (const auto& counter : counters_) ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+#endif
+	}
+
+	// Counting accumulates over any number of start()/stop() pairs until the next reset()
+	void start()
+	{
+#if defined(__linux__)
+		for (const auto& counter : counters_) ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+
+	void stop()
+	{
+#if defined(__linux__)
+		for (const auto& counter : counters_) ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+	}
+
+	std::vector<Reading> read() const
+	{
+		std::vector<Reading> readings;
+#if defined(__linux__)
+		for (const auto& counter : counters_)
+		{
+			// With PERF_FORMAT_TOTAL_TIME_* we can scale the value if the kernel had to multiplex the counters
+			uint64_t data[3] = {0, 0, 0};
+			if (::read(counter.fd, data, sizeof(data)) != sizeof(data)) continue;
+			const double scale = data[2] > 0 ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 1.0;
+			readings.push_back({counter.name, static_cast<double>(data[0]) * scale});
+		}
+#endif
+		return readings;
+	}
+
+   private:
+	struct Counter {
+		std::string name;
+		int fd;
+	};
+
+	std::vector<Counter> counters_;
+
+#if defined(__linux__)
+	void open(std::string name, uint32_t type, uint64_t config)
+	{
+		perf_event_attr attr{};
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		if (fd >= 0) counters_.push_back({std::move(name), fd});
+	}
+#endif
+};
+
+}  // namespace Bench
@@ -0,0 +1,192 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <easys/ecs.hpp>
+#include <easys/pool_access.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct AccessConflict : std::runtime_error {
+	using std::runtime_error::runtime_error;
+};
+
+// Makes conflicts throw AccessConflict while alive and restores the previous handler afterwards, so that the tests
+// built into the same executable after this one keep the default handler
+class ThrowingConflictHandler {
+   public:
+	ThrowingConflictHandler()
+	    : previous(Easys::setAccessConflictHandler([](const std::string& message) { throw AccessConflict(message); }))
+	{
+	}
+	ThrowingConflictHandler(const ThrowingConflictHandler&) = delete;
+	ThrowingConflictHandler& operator=(const ThrowingConflictHandler&) = delete;
+	~ThrowingConflictHandler() { Easys::setAccessConflictHandler(previous); }
+
+   private:
+	Easys::AccessConflictHandler previous;
+};
+
+const char* poolName() { return "Position"; }
+
+// Runs func on another thread and returns the message of the conflict it caused, or an empty string
+template <typename Func>
+std::string conflictOnOtherThread(Func&& func)
+{
+	std::string message;
+	std::thread thread(
+	    [&]
+	    {
+		    try
+		    {
+			    func();
+		    } catch (const AccessConflict& conflict)
+		    {
+			    message = conflict.what();
+		    }
+	    });
+	thread.join();
+	return message;
+}
+
+struct AccessPosition {
+	float x;
+};
+
+struct AccessVelocity {
+	float x;
+};
+
+}  // namespace
+
+TEST_CASE("PoolAccess detects conflicting access", "[PoolAccess]")
+{
+	const ThrowingConflictHandler handler;
+	Easys::PoolAccess<Easys::AccessMode::Check> access;
+
+	SECTION("Readers share a pool")
+	{
+		access.beginRead(poolName);
+		REQUIRE(conflictOnOtherThread(
+		            [&]
+		            {
+			            access.beginRead(poolName);
+			            access.endRead();
+		            })
+		            .empty());
+		access.endRead();
+	}
+
+	SECTION("Writing while another thread reads is reported")
+	{
+		access.beginRead(poolName);
+		const std::string message = conflictOnOtherThread([&] { access.beginWrite(poolName); });
+		REQUIRE(message == "Easys: conflicting access to component Position: write while 1 thread(s) read it");
+		access.endRead();
+
+		REQUIRE(conflictOnOtherThread(
+		            [&]
+		            {
+			            access.beginWrite(poolName);
+			            access.endWrite();
+		            })
+		            .empty());
+	}
+
+	SECTION("Reading while another thread writes is reported")
+	{
+		access.beginWrite(poolName);
+		REQUIRE(conflictOnOtherThread([&] { access.beginRead(poolName); })
+		        == "Easys: conflicting access to component Position: read while another thread writes it");
+		access.endWrite();
+	}
+
+	SECTION("The writing thread may access its pool again")
+	{
+		access.beginWrite(poolName);
+		access.beginWrite(poolName);
+		access.beginRead(poolName);
+		access.endRead();
+		access.endWrite();
+		REQUIRE_FALSE(conflictOnOtherThread([&] { access.beginRead(poolName); }).empty());
+		access.endWrite();
+	}
+
+	SECTION("Guards claim pools once and release them on a conflict")
+	{
+		Easys::PoolAccess<Easys::AccessMode::Check> other;
+		using Claim = Easys::PoolClaim<Easys::AccessMode::Check>;
+		{
+			Easys::AccessGuard<Easys::AccessMode::Check, 3> guard(
+			    {Claim{1, &other, poolName, false}, Claim{0, &access, poolName, false}, Claim{0, &access, poolName, true}});
+			REQUIRE_FALSE(conflictOnOtherThread([&] { access.beginRead(poolName); }).empty());
+		}
+
+		other.beginWrite(poolName);
+		REQUIRE_FALSE(conflictOnOtherThread(
+		                  [&]
+		                  {
+			                  Easys::AccessGuard<Easys::AccessMode::Check, 2>(
+			                      {Claim{0, &access, poolName, true}, Claim{1, &other, poolName, false}});
+		                  })
+		                  .empty());
+		other.endWrite();
+
+		// The failed guard released the pool it already had
+		REQUIRE(conflictOnOtherThread(
+		            [&]
+		            {
+			            access.beginWrite(poolName);
+			            access.endWrite();
+		            })
+		            .empty());
+	}
+}
+
+TEST_CASE("PoolAccess locks pools", "[PoolAccess]")
+{
+	Easys::PoolAccess<Easys::AccessMode::Lock> access;
+	std::atomic<bool> written = false;
+
+	access.beginRead(poolName);
+	std::thread writer(
+	    [&]
+	    {
+		    access.beginWrite(poolName);
+		    written = true;
+		    access.endWrite();
+	    });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	REQUIRE_FALSE(written);
+	access.endRead();
+	writer.join();
+	REQUIRE(written);
+}
+
+TEST_CASE("ECS read-only queries", "[ECS][PoolAccess]")
+{
+	Easys::ECS<AccessPosition, AccessVelocity> ecs;
+	for (int i = 0; i < 3; i++)
+	{
+		const auto e = ecs.addEntity();
+		ecs.addComponent(e, AccessPosition{static_cast<float>(i)});
+		ecs.addComponent(e, AccessVelocity{1.0f});
+	}
+
+	float sum = 0.0f;
+	ecs.forEach<const AccessPosition, AccessVelocity>(
+	    [&](Easys::Entity, const AccessPosition& p, AccessVelocity& v)
+	    {
+		    static_assert(std::is_const_v<std::remove_reference_t<decltype(p)>>);
+		    v.x += p.x;
+		    sum += p.x;
+	    });
+	REQUIRE(sum == 3.0f);
+
+	[[maybe_unused]] const auto guard = ecs.lock<const AccessPosition, AccessVelocity>();
+	ecs.forEach<const AccessPosition>([&](Easys::Entity, const AccessPosition& p) { sum += p.x; });
+	REQUIRE(sum == 6.0f);
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <easys/ecs.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PrefabHealth {
+	int value;
+};
+
+struct PrefabName {
+	std::string value;
+};
+
+struct PrefabPosition {
+	float x, y;
+};
+
+struct PrefabPositionOf {
+	std::array<float, 2> operator()(const PrefabPosition& p) const { return {p.x, p.y}; }
+};
+
+}  // namespace
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, PrefabPosition> {
+	using type = Easys::SpatialSparseSet<Key, PrefabPosition, PrefabPositionOf>;
+};
+
+TEST_CASE("Prefabs", "[ECS][Prefab]")
+{
+	Easys::ECS<PrefabHealth, PrefabName, PrefabPosition> ecs;
+	Easys::Prefab goblin(PrefabHealth{30}, PrefabName{"goblin"});
+
+	SECTION("Instantiating creates entities with copies of the prefab values")
+	{
+		const auto wave = ecs.instantiate(goblin, 100);
+
+		REQUIRE(wave.size() == 100);
+		REQUIRE(ecs.getEntityCount() == 100);
+		REQUIRE(ecs.getComponentCount<PrefabHealth>() == 100);
+		REQUIRE(ecs.getComponentCount<PrefabPosition>() == 0);
+		for (const auto e : wave)
+		{
+			REQUIRE(ecs.hasEntity(e));
+			REQUIRE(ecs.getComponent<PrefabHealth>(e).value == 30);
+			REQUIRE(ecs.getComponent<PrefabName>(e).value == "goblin");
+		}
+		REQUIRE(ecs.getEntitiesByComponent<PrefabHealth>() == wave);
+
+		ecs.getComponent<PrefabHealth>(wave[0]).value = 0;
+		REQUIRE(ecs.getComponent<PrefabHealth>(wave[1]).value == 30);
+	}
+
+	SECTION("Instances mix with existing entities and reuse freed IDs")
+	{
+		const auto first = ecs.instantiate(goblin, 10);
+		ecs.removeEntity(first[3]);
+		ecs.addComponent(ecs.addEntity(), PrefabHealth{1});
+
+		goblin.get<PrefabHealth>().value = 60;
+		const auto second = ecs.instantiate(goblin, 10);
+		REQUIRE(ecs.getEntityCount() == 20);
+		REQUIRE(ecs.getComponentCount<PrefabHealth>() == 20);
+		for (const auto e : second) REQUIRE(ecs.getComponent<PrefabHealth>(e).value == 60);
+		REQUIRE(ecs.getComponent<PrefabHealth>(first[0]).value == 30);
+	}
+
+	SECTION("A single instance can be created")
+	{
+		const auto e = ecs.instantiate(goblin);
+		REQUIRE(ecs.getComponent<PrefabName>(e).value == "goblin");
+		REQUIRE(ecs.instantiate(goblin, 0).empty());
+	}
+
+	SECTION("Instances are added to specialized storage")
+	{
+		const auto wave = ecs.instantiate(Easys::Prefab(PrefabPosition{5.0f, 5.0f}), 3);
+
+		std::vector<Easys::Entity> found;
+		ecs.queryRadius<PrefabPosition>(5.0f, 5.0f, 1.0f, found);
+		std::sort(found.begin(), found.end());
+		REQUIRE(found == wave);
+	}
+
+	SECTION("Instantiating more entities than available throws")
+	{
+		REQUIRE_THROWS_AS(ecs.instantiate(goblin, Easys::MAX_ENTITIES + 1), std::runtime_error);
+		REQUIRE(ecs.getEntityCount() == 0);
+	}
+}
@@ -0,0 +1,127 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <easys/profiler.hpp>
+#include <sstream>
+#include <thread>
+
+TEST_CASE("Profiler functionality", "[Profiler]")
+{
+	Easys::Profiler profiler(8);
+
+	SECTION("Capacity is rounded up to a power of two")
+	{
+		Easys::Profiler odd(5);
+		REQUIRE(odd.capacity() == 8);
+	}
+
+	SECTION("Scopes record events and propagate entity counts to their parent")
+	{
+		{
+			Easys::Profiler::Scope system(profiler, "system", Easys::ProfileEventType::System);
+			{
+				Easys::Profiler::Scope query(profiler, "query", Easys::ProfileEventType::Query);
+				query.addEntities(10);
+				profiler.addStructuralChanges(3);
+			}
+		}
+
+		auto events = profiler.events();
+		REQUIRE(events.size() == 2);
+		REQUIRE(std::string(events[0].name) == "query");
+		REQUIRE(events[0].entities == 10);
+		REQUIRE(events[0].structuralChanges == 3);
+		REQUIRE(std::string(events[1].name) == "system");
+		REQUIRE(events[1].type == Easys::ProfileEventType::System);
+		REQUIRE(events[1].entities == 10);
+		REQUIRE(events[1].structuralChanges == 3);
+		REQUIRE(events[1].duration >= events[0].duration);
+	}
+
+	SECTION("The ring buffer keeps the most recent events")
+	{
+		const char* names[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+		for (const char* name : names) profiler.record({name});
+
+		auto events = profiler.events();
+		REQUIRE(profiler.recordedEvents() == 10);
+		REQUIRE(events.size() == 8);
+		REQUIRE(std::string(events.front().name) == "2");
+		REQUIRE(std::string(events.back().name) == "9");
+	}
+
+	SECTION("Frames count structural changes since the previous frame")
+	{
+		profiler.addStructuralChanges(4);
+		profiler.endFrame();
+		profiler.addStructuralChanges(1);
+		profiler.endFrame();
+
+		auto events = profiler.events();
+		REQUIRE(events.size() == 2);
+		REQUIRE(events[0].type == Easys::ProfileEventType::Frame);
+		REQUIRE(events[0].structuralChanges == 4);
+		REQUIRE(events[1].structuralChanges == 1);
+		REQUIRE(events[1].start == events[0].start + events[0].duration);
+	}
+
+	SECTION("Recording from multiple threads")
+	{
+		Easys::Profiler shared(1024);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++)
+		{
+			threads.emplace_back(
+			    [&shared]
+			    {
+				    for (int i = 0; i < 100; i++) shared.record({"event"});
+			    });
+		}
+		for (auto& thread : threads) thread.join();
+
+		REQUIRE(shared.events().size() == 400);
+	}
+
+	SECTION("Reading while other threads overwrite the buffer")
+	{
+		Easys::Profiler shared(16);
+		std::atomic<bool> done = false;
+		std::thread writer(
+		    [&]
+		    {
+			    for (uint64_t i = 0; i < 20000; i++) shared.record({"event", Easys::ProfileEventType::Query, 0, i, i});
+			    done = true;
+		    });
+
+		bool consistent = true;
+		while (!done)
+		{
+			for (const Easys::ProfileEvent& event : shared.events()) consistent = consistent && event.start == event.duration;
+		}
+		writer.join();
+
+		REQUIRE(consistent);
+		REQUIRE(shared.events().size() == 16);
+	}
+
+	SECTION("Chrome trace export")
+	{
+		{
+			Easys::Profiler::Scope scope(profiler, "movement", Easys::ProfileEventType::System);
+			scope.addEntities(2);
+		}
+
+		std::ostringstream oss;
+		profiler.writeChromeTrace(oss);
+		const std::string trace = oss.str();
+
+		REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+		REQUIRE(trace.find("\"name\": \"movement\"") != std::string::npos);
+		REQUIRE(trace.find("\"cat\": \"system\"") != std::string::npos);
+		REQUIRE(trace.find("\"entities\": 2") != std::string::npos);
+	}
+
+	SECTION("Readable query names")
+	{
+		REQUIRE(std::string(Easys::queryName<int, float>()) == "forEach<int, float>");
+	}
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 #include <easys/entity.hpp>
 #include <easys/registry.hpp>
+#include <string>
 
 #define COMPONENT_TYPES TestComponent, AnotherComponent
 
@@ -227,4 +228,35 @@ TEST_CASE("Registry clear functionality", "[Registry]")
 		REQUIRE_FALSE(registry.hasComponent<Position>(entity));
 		REQUIRE_FALSE(registry.hasComponent<Velocity>(entity));
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("Component pools are looked up by type index", "[Registry]")
+{
+	STATIC_REQUIRE(typeIndex<int, int, float, double> == 0);
+	STATIC_REQUIRE(typeIndex<double, int, float, double> == 2);
+	STATIC_REQUIRE(typeIndex<char, int, float, double> == 3);
+	STATIC_REQUIRE(containsType<float, int, float>);
+	STATIC_REQUIRE_FALSE(containsType<char, int, float>);
+	STATIC_REQUIRE_FALSE(containsType<int>);
+
+	ComponentPools<Entity, TestComponent, AnotherComponent> pools;
+	pools.get<AnotherComponent>().set(3, AnotherComponent{30});
+	REQUIRE(pools.get<TestComponent>().size() == 0);
+	REQUIRE(std::as_const(pools).get<AnotherComponent>().get(3).value == 30);
+}
+
+TEST_CASE("Registries with runtime components can be copied", "[Registry]")
+{
+	Registry<COMPONENT_TYPES> registry;
+	const ComponentId name = registry.registerComponent(ComponentDescriptor::of<std::string>("Name"));
+	const std::string value = "a name that does not fit into the small string buffer";
+	registry.addComponent(1, name, &value);
+	registry.addComponent<TestComponent>(1, TestComponent{10});
+
+	Registry<COMPONENT_TYPES> copy = registry;
+	registry.removeComponent(1, name);
+
+	REQUIRE(copy.findComponent("Name") == name);
+	REQUIRE(*static_cast<const std::string*>(copy.getComponent(1, name)) == value);
+	REQUIRE(copy.getComponent<TestComponent>(1).value == 10);
+}
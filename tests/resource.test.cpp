@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+#include <easys/ecs.hpp>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+struct FrameTime {
+	float delta = 0.0f;
+	int frame = 0;
+};
+
+struct GameConfig {
+	int maxPlayers = 4;
+};
+
+struct ResourcePosition {
+	float x, y;
+};
+
+}  // namespace
+
+TEST_CASE("World-level resources", "[ECS][Resources]")
+{
+	Easys::ECS<ResourcePosition, Easys::Resources<FrameTime, GameConfig>> ecs;
+
+	SECTION("Resources are value-initialized")
+	{
+		REQUIRE(ecs.resource<FrameTime>().frame == 0);
+		REQUIRE(ecs.resource<GameConfig>().maxPlayers == 4);
+	}
+
+	SECTION("Resources can be modified and replaced")
+	{
+		ecs.resource<FrameTime>().frame++;
+		ecs.setResource(GameConfig{16});
+
+		const auto& constEcs = ecs;
+		REQUIRE(constEcs.resource<FrameTime>().frame == 1);
+		REQUIRE(constEcs.resource<GameConfig>().maxPlayers == 16);
+		REQUIRE(&ecs.resource<FrameTime>() == &constEcs.resource<FrameTime>());
+	}
+
+	SECTION("Resources are not components")
+	{
+		const auto e = ecs.addEntity();
+		ecs.addComponent(e, ResourcePosition{1.0f, 2.0f});
+		ecs.resource<FrameTime>().delta = 0.5f;
+
+		REQUIRE(ecs.getComponentCount() == 1);
+		REQUIRE(ecs.memoryStats().components.size() == 1);
+
+		ecs.clear();
+		REQUIRE(ecs.resource<FrameTime>().delta == 0.5f);
+	}
+
+	SECTION("Systems read resources")
+	{
+		ecs.resource<FrameTime>().delta = 2.0f;
+		ecs.addComponent(ecs.addEntity(), ResourcePosition{1.0f, 0.0f});
+
+		ecs.forEach<ResourcePosition>([&](Easys::Entity, ResourcePosition& p)
+		                              { p.x *= ecs.resource<FrameTime>().delta; });
+
+		REQUIRE(ecs.getComponent<ResourcePosition>(ecs.getEntitiesByComponent<ResourcePosition>()[0]).x == 2.0f);
+	}
+
+	SECTION("Resources can be read from several threads")
+	{
+		ecs.setResource(GameConfig{8});
+		const auto& world = ecs;
+
+		std::vector<long> sums(4, 0);
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < sums.size(); t++)
+		{
+			threads.emplace_back(
+			    [&world, &sums, t]
+			    {
+				    for (int i = 0; i < 10000; i++) sums[t] += world.resource<GameConfig>().maxPlayers;
+			    });
+		}
+		for (auto& thread : threads) thread.join();
+
+		for (const long sum : sums) REQUIRE(sum == 80000);
+	}
+
+	SECTION("A world without resources does not grow")
+	{
+		STATIC_REQUIRE(sizeof(Easys::ECS<ResourcePosition>) == sizeof(Easys::ECS<ResourcePosition, Easys::Resources<>>));
+	}
+}
@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 #include <easys/sparse_set.hpp>
+#include <easys/storage.hpp>
 
 TEST_CASE("SparseSet functionality", "[SparseSet]")
 {
@@ -32,7 +33,21 @@ TEST_CASE("SparseSet functionality", "[SparseSet]")
 	{
 		SparseSet<unsigned int, int> set;
 		set.set(1, 100);
+#if EASYS_CHECKED
 		REQUIRE_THROWS_AS(set.get(2), KeyNotFoundException);
+#endif
+	}
+
+	SECTION("tryGet returns a pointer or nullptr")
+	{
+		SparseSet<unsigned int, int> set;
+		set.set(1, 100);
+
+		REQUIRE(set.tryGet(1) != nullptr);
+		REQUIRE(*set.tryGet(1) == 100);
+		REQUIRE(set.tryGet(2) == nullptr);
+		REQUIRE(set.tryGet(1000) == nullptr);
+		REQUIRE(set[1] == 100);
 	}
 
 	SECTION("Check existence of elements")
@@ -58,6 +73,20 @@ TEST_CASE("SparseSet functionality", "[SparseSet]")
 		REQUIRE(set.contains(2));
 	}
 
+	SECTION("Set many keys at once")
+	{
+		SparseSet<unsigned int, int> set;
+		set.set(3, 300);
+		const std::vector<unsigned int> keys = {10, 3, 7};
+		set.set(keys, 1);
+
+		REQUIRE(set.size() == 3);
+		REQUIRE(set.get(10) == 1);
+		REQUIRE(set.get(3) == 1);
+		REQUIRE(set.get(7) == 1);
+		REQUIRE(set.getKeys() == std::vector<unsigned int>{3, 10, 7});
+	}
+
 	SECTION("forEach iteration")
 	{
 		SparseSet<unsigned int, int> set;
@@ -127,4 +156,241 @@ TEST_CASE("SparseSet clear functionality", "[SparseSet]")
 		sparseSet.clear();
 		REQUIRE(sparseSet.size() == 0);  // Ensure the sparse set is empty
 	}
-}
\ No newline at end of file
+}
+TEST_CASE("SparseSet capacity control", "[SparseSet]")
+{
+	SparseSet<unsigned int, int> set;
+
+	SECTION("reserve preallocates values without adding elements")
+	{
+		set.reserve(100);
+		REQUIRE(set.size() == 0);
+		REQUIRE(set.capacity() >= 100);
+	}
+
+	SECTION("reserve prevents reallocation on insertion")
+	{
+		set.reserve(100);
+		set.set(0, 1);
+		const int* first = &set.get(0);
+		for (unsigned int i = 1; i < 100; i++) set.set(i, i);
+		REQUIRE(&set.get(0) == first);
+	}
+
+	SECTION("reserveKeys sizes the sparse array")
+	{
+		set.reserveKeys(64);
+		REQUIRE(set.keyCapacity() == 64);
+		set.set(63, 1);
+		REQUIRE(set.keyCapacity() == 64);
+		REQUIRE_FALSE(set.contains(62));
+	}
+
+	SECTION("shrinkToFit releases memory and keeps elements")
+	{
+		for (unsigned int i = 0; i < 100; i++) set.set(i, i);
+		for (unsigned int i = 10; i < 100; i++) set.remove(i);
+		set.shrinkToFit();
+
+		REQUIRE(set.size() == 10);
+		REQUIRE(set.capacity() == 10);
+		REQUIRE(set.keyCapacity() == 10);
+		REQUIRE(set.get(9) == 9);
+		REQUIRE_FALSE(set.contains(10));
+	}
+
+	SECTION("shrinkToFit on an empty set releases everything")
+	{
+		set.set(1000, 1);
+		set.remove(1000);
+		set.shrinkToFit();
+		REQUIRE(set.capacity() == 0);
+		REQUIRE(set.keyCapacity() == 0);
+	}
+}
+
+TEST_CASE("SparseSet batched removal", "[SparseSet]")
+{
+	SparseSet<unsigned int, int> set;
+	for (unsigned int i = 0; i < 10; i++) set.set(i, static_cast<int>(i) * 10);
+
+	SECTION("Removes all given keys and ignores unknown ones")
+	{
+		std::vector<unsigned int> keys = {1, 3, 3, 5, 42};
+		set.remove(keys);
+
+		REQUIRE(set.size() == 7);
+		REQUIRE_FALSE(set.contains(1));
+		REQUIRE_FALSE(set.contains(3));
+		REQUIRE_FALSE(set.contains(5));
+		for (unsigned int key : {0u, 2u, 4u, 6u, 7u, 8u, 9u}) REQUIRE(set.get(key) == static_cast<int>(key) * 10);
+	}
+
+	SECTION("Preserves the order of the remaining keys")
+	{
+		std::vector<unsigned int> keys = {0, 4, 9};
+		set.remove(keys, true);
+
+		REQUIRE(set.getKeys() == std::vector<unsigned int>{1, 2, 3, 5, 6, 7, 8});
+		REQUIRE(set.getValues() == std::vector<int>{10, 20, 30, 50, 60, 70, 80});
+		REQUIRE(set.get(8) == 80);
+	}
+
+	SECTION("Removing every key leaves the set empty")
+	{
+		set.remove(set.getKeys());
+		REQUIRE(set.size() == 0);
+		REQUIRE_FALSE(set.contains(0));
+	}
+
+	SECTION("Removing a tail of keys")
+	{
+		std::vector<unsigned int> keys = {7, 8, 9, 0};
+		set.remove(keys);
+
+		REQUIRE(set.size() == 6);
+		for (unsigned int key : {1u, 2u, 3u, 4u, 5u, 6u}) REQUIRE(set.get(key) == static_cast<int>(key) * 10);
+	}
+}
+
+TEST_CASE("SparseSet in-place deletion policy", "[SparseSet]")
+{
+	SparseSet<unsigned int, int, std::vector<int>, DeletionPolicy::InPlace> set;
+	for (unsigned int i = 0; i < 10; i++) set.set(i, static_cast<int>(i));
+
+	SECTION("Removal keeps the order of the remaining values")
+	{
+		set.remove(0);
+		set.remove(5);
+
+		REQUIRE(set.size() == 8);
+		REQUIRE_FALSE(set.contains(0));
+		REQUIRE(set.get(9) == 9);
+		REQUIRE(set.getKeys() == std::vector<unsigned int>{1, 2, 3, 4, 6, 7, 8, 9});
+		REQUIRE(set.getValues() == std::vector<int>{1, 2, 3, 4, 6, 7, 8, 9});
+	}
+
+	SECTION("forEach skips removed values")
+	{
+		set.remove(3);
+		std::vector<unsigned int> keys;
+		set.forEach(
+		    [&keys](auto key, auto)
+		    {
+			    keys.push_back(key);
+		    });
+		REQUIRE(keys == std::vector<unsigned int>{0, 1, 2, 4, 5, 6, 7, 8, 9});
+	}
+
+	SECTION("Re-adding a removed key appends it")
+	{
+		set.remove(2);
+		set.set(2, 20);
+		REQUIRE(set.size() == 10);
+		REQUIRE(set.getKeys().back() == 2);
+		REQUIRE(set.get(2) == 20);
+	}
+
+	SECTION("Removing everything compacts automatically")
+	{
+		for (unsigned int i = 0; i < 10; i++) set.remove(i);
+		REQUIRE(set.size() == 0);
+		REQUIRE(set.getKeys().empty());
+	}
+
+	SECTION("Batched removal always keeps the order")
+	{
+		std::vector<unsigned int> keys = {0, 1};
+		set.remove(keys);
+		REQUIRE(set.getKeys() == std::vector<unsigned int>{2, 3, 4, 5, 6, 7, 8, 9});
+	}
+}
+
+TEST_CASE("SparseSet memory statistics", "[SparseSet]")
+{
+	SparseSet<unsigned int, double> set;
+	REQUIRE(set.memoryStats().used() == 0);
+	REQUIRE(set.memoryStats().sparseFillRatio == 0.0);
+
+	set.set(0, 1.0);
+	set.set(99, 2.0);
+	auto stats = set.memoryStats();
+	REQUIRE(stats.sparseUsed >= 100 * sizeof(unsigned int));
+	REQUIRE(stats.denseUsed == 2 * sizeof(unsigned int));
+	REQUIRE(stats.valuesUsed == 2 * sizeof(double));
+	REQUIRE(stats.sparseFillRatio == Approx(2.0 / (stats.sparseUsed / sizeof(unsigned int))));
+	REQUIRE(stats.reserved() >= stats.used());
+
+	set.shrinkToFit();
+	REQUIRE(set.memoryStats().sparseUsed == 100 * sizeof(unsigned int));
+	REQUIRE(set.memoryStats().sparseFillRatio == Approx(0.02));
+
+	set.reserve(64);
+	REQUIRE(set.memoryStats().valuesReserved >= 64 * sizeof(double));
+}
+
+TEST_CASE("SparseSet reorder", "[SparseSet]")
+{
+	SparseSet<unsigned int, int> set;
+	for (unsigned int i = 0; i < 6; i++) set.set(i, static_cast<int>(i) * 10);
+
+	std::vector<unsigned int> order = {4, 2, 9, 4, 0};
+	set.reorder(order);
+	const auto& keys = set.getKeys();
+	REQUIRE(std::vector<unsigned int>(keys.begin(), keys.begin() + 3) == std::vector<unsigned int>{4, 2, 0});
+	for (unsigned int i = 0; i < 6; i++) REQUIRE(set.get(i) == static_cast<int>(i) * 10);
+
+	std::vector<unsigned int> reversed(keys.rbegin(), keys.rend());
+	set.reorder(reversed);
+	REQUIRE(set.getKeys() == reversed);
+
+	// The order may be a view of the keys themselves
+	set.reorder(set.getKeys());
+	REQUIRE(set.getKeys() == reversed);
+
+	// Keys that are not part of the order keep their relative order
+	set.reorder(std::vector<unsigned int>{3});
+	REQUIRE(set.getKeys() == std::vector<unsigned int>{3, 5, 1, 0, 2, 4});
+}
+
+TEST_CASE("SparseSet sort", "[SparseSet]")
+{
+	SparseSet<unsigned int, int> set;
+	const std::vector<int> values = {5, 3, 8, 3, 1, 9, 0, 5};
+	for (unsigned int i = 0; i < values.size(); i++) set.set(i, values[i]);
+
+	set.sort([](int a, int b) { return a < b; });
+	REQUIRE(set.getValues() == std::vector<int>{0, 1, 3, 3, 5, 5, 8, 9});
+	REQUIRE(set.getKeys() == std::vector<unsigned int>{6, 4, 1, 3, 0, 7, 2, 5});  // stable
+	for (unsigned int i = 0; i < values.size(); i++) REQUIRE(set.get(i) == values[i]);
+
+	set.remove(4);
+	set.sort([](int a, int b) { return a > b; });
+	REQUIRE(set.getValues() == std::vector<int>{9, 8, 5, 5, 3, 3, 0});
+	for (unsigned int i = 0; i < values.size(); i++)
+	{
+		if (i != 4) REQUIRE(set.get(i) == values[i]);
+	}
+}
+
+TEST_CASE("SparseSet with a compact index type", "[SparseSet]")
+{
+	static_assert(std::is_same_v<Easys::CompactIndex<255>, uint8_t>);
+	static_assert(std::is_same_v<Easys::CompactIndex<256>, uint16_t>);
+	static_assert(std::is_same_v<Easys::CompactIndex<65535>, uint16_t>);
+	static_assert(std::is_same_v<Easys::CompactIndex<65536>, uint32_t>);
+
+	Easys::CompactSparseSet<uint32_t, int, 200> set;
+	for (uint32_t i = 0; i < 255; i++) set.set(i * 1000, static_cast<int>(i));
+	REQUIRE_THROWS_AS(set.set(999999, 0), std::length_error);
+	set.set(0, -1);  // updating an existing key needs no new slot
+	REQUIRE(set.get(0) == -1);
+
+	set.remove(1000);
+	set.set(999999, 7);
+	REQUIRE(set.get(999999) == 7);
+	for (uint32_t i = 2; i < 255; i++) REQUIRE(set.get(i * 1000) == static_cast<int>(i));
+
+	const auto stats = set.memoryStats();
+	REQUIRE(stats.sparseUsed == set.keyCapacity() * sizeof(uint8_t));
+}
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <easys/ecs.hpp>
+#include <easys/spatial_index.hpp>
+#include <random>
+#include <vector>
+
+struct SpatialPosition {
+	float x, y;
+};
+
+struct SpatialPositionOf {
+	std::array<float, 2> operator()(const SpatialPosition& p) const { return {p.x, p.y}; }
+};
+
+template <typename Key>
+struct Easys::ComponentStorage<Key, SpatialPosition> {
+	using type = Easys::SpatialSparseSet<Key, SpatialPosition, SpatialPositionOf>;
+};
+
+static std::vector<Easys::Entity> sorted(std::vector<Easys::Entity> entities)
+{
+	std::sort(entities.begin(), entities.end());
+	return entities;
+}
+
+TEST_CASE("SpatialGrid functionality", "[SpatialGrid]")
+{
+	Easys::SpatialGrid<uint32_t> grid(10.0f);
+	std::vector<uint32_t> result;
+
+	SECTION("Box queries are inclusive and span cells")
+	{
+		grid.set(1, 0.0f, 0.0f);
+		grid.set(2, 15.0f, 5.0f);
+		grid.set(3, -25.0f, -5.0f);
+		grid.set(4, 40.0f, 40.0f);
+
+		grid.queryBox(0.0f, 0.0f, 15.0f, 5.0f, result);
+		std::sort(result.begin(), result.end());
+		REQUIRE(result == std::vector<uint32_t>{1, 2});
+
+		grid.queryBox(-30.0f, -10.0f, 0.0f, 0.0f, result);
+		std::sort(result.begin(), result.end());
+		REQUIRE(result == std::vector<uint32_t>{1, 3});
+
+		grid.queryBox(5.0f, 5.0f, 0.0f, 0.0f, result);
+		REQUIRE(result.empty());
+	}
+
+	SECTION("Radius queries use the distance, not the cells")
+	{
+		grid.set(1, 0.0f, 0.0f);
+		grid.set(2, 3.0f, 4.0f);
+		grid.set(3, 4.0f, 4.0f);
+
+		grid.queryRadius(0.0f, 0.0f, 5.0f, result);
+		std::sort(result.begin(), result.end());
+		REQUIRE(result == std::vector<uint32_t>{1, 2});
+	}
+
+	SECTION("Moving and removing keys")
+	{
+		grid.set(1, 0.0f, 0.0f);
+		grid.set(2, 1.0f, 1.0f);
+		grid.set(3, 2.0f, 2.0f);
+		grid.set(1, 100.0f, 100.0f);
+		grid.remove(2);
+		grid.remove(42);
+
+		REQUIRE(grid.size() == 2);
+		REQUIRE_FALSE(grid.contains(2));
+		grid.queryBox(0.0f, 0.0f, 9.0f, 9.0f, result);
+		REQUIRE(result == std::vector<uint32_t>{3});
+		grid.queryRadius(100.0f, 100.0f, 1.0f, result);
+		REQUIRE(result == std::vector<uint32_t>{1});
+	}
+
+	SECTION("Changing the cell size keeps all keys")
+	{
+		for (uint32_t i = 0; i < 50; i++) grid.set(i, static_cast<float>(i), 0.0f);
+		grid.setCellSize(3.0f);
+
+		REQUIRE(grid.cellSize() == 3.0f);
+		REQUIRE(grid.size() == 50);
+		grid.queryBox(10.0f, -1.0f, 19.0f, 1.0f, result);
+		REQUIRE(result.size() == 10);
+		REQUIRE_THROWS_AS(grid.setCellSize(0.0f), std::invalid_argument);
+	}
+
+	SECTION("Queries match a linear scan")
+	{
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+		std::vector<std::array<float, 2>> positions(500);
+		for (uint32_t i = 0; i < positions.size(); i++)
+		{
+			positions[i] = {coordinate(rng), coordinate(rng)};
+			grid.set(i, positions[i][0], positions[i][1]);
+		}
+
+		for (int query = 0; query < 20; query++)
+		{
+			const float x = coordinate(rng), y = coordinate(rng), radius = query * 5.0f;
+			std::vector<uint32_t> expected;
+			for (uint32_t i = 0; i < positions.size(); i++)
+			{
+				const float dx = positions[i][0] - x, dy = positions[i][1] - y;
+				if (dx * dx + dy * dy <= radius * radius) expected.push_back(i);
+			}
+
+			grid.queryRadius(x, y, radius, result);
+			std::sort(result.begin(), result.end());
+			REQUIRE(result == expected);
+		}
+	}
+}
+
+TEST_CASE("ECS spatial queries", "[ECS][SpatialGrid]")
+{
+	Easys::ECS<SpatialPosition, int> ecs;
+	ecs.setSpatialCellSize<SpatialPosition>(4.0f);
+	std::vector<Easys::Entity> result;
+
+	const auto a = ecs.addEntity();
+	const auto b = ecs.addEntity();
+	const auto c = ecs.addEntity();
+	ecs.addComponent(a, SpatialPosition{0.0f, 0.0f});
+	ecs.addComponent(b, SpatialPosition{2.0f, 0.0f});
+	ecs.addComponent(c, SpatialPosition{50.0f, 50.0f});
+
+	SECTION("Memory statistics include the grid")
+	{
+		const auto stats = ecs.memoryStats().components[0];
+		REQUIRE(stats.pool.indexBytes > 0);
+		REQUIRE(stats.pool.reserved() >= stats.pool.valuesReserved + stats.pool.indexBytes);
+	}
+
+	SECTION("Adding components indexes them")
+	{
+		ecs.queryRadius<SpatialPosition>(0.0f, 0.0f, 3.0f, result);
+		REQUIRE(sorted(result) == std::vector<Easys::Entity>{a, b});
+		ecs.queryBox<SpatialPosition>(40.0f, 40.0f, 60.0f, 60.0f, result);
+		REQUIRE(result == std::vector<Easys::Entity>{c});
+	}
+
+	SECTION("Removing components and entities removes them from the index")
+	{
+		ecs.removeComponent<SpatialPosition>(a);
+		ecs.removeEntity(c);
+
+		ecs.queryBox<SpatialPosition>(-100.0f, -100.0f, 100.0f, 100.0f, result);
+		REQUIRE(result == std::vector<Easys::Entity>{b});
+
+		ecs.clear();
+		ecs.queryBox<SpatialPosition>(-100.0f, -100.0f, 100.0f, 100.0f, result);
+		REQUIRE(result.empty());
+	}
+
+	SECTION("In-place changes are picked up after an update")
+	{
+		ecs.forEach<SpatialPosition>([](Easys::Entity, SpatialPosition& p) { p.x += 100.0f; });
+
+		ecs.queryRadius<SpatialPosition>(0.0f, 0.0f, 3.0f, result);
+		REQUIRE(result.size() == 2);
+
+		ecs.updateSpatialIndex<SpatialPosition>();
+		ecs.queryRadius<SpatialPosition>(0.0f, 0.0f, 3.0f, result);
+		REQUIRE(result.empty());
+		ecs.queryRadius<SpatialPosition>(100.0f, 0.0f, 3.0f, result);
+		REQUIRE(sorted(result) == std::vector<Easys::Entity>{a, b});
+
+		ecs.getComponent<SpatialPosition>(c).x = 0.0f;
+		ecs.getComponent<SpatialPosition>(c).y = 0.0f;
+		ecs.updateSpatialIndex<SpatialPosition>(c);
+		ecs.queryRadius<SpatialPosition>(0.0f, 0.0f, 1.0f, result);
+		REQUIRE(result == std::vector<Easys::Entity>{c});
+	}
+}
@@ -0,0 +1,202 @@
+#include <catch2/catch.hpp>
+#include <easys/ecs.hpp>
+#include <easys/task.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// An in-process stand-in for an asset loader or a database: requests stay pending until the test completes them
+class FakeIo {
+   public:
+	Easys::AsyncOperation<std::string> load(std::string path)
+	{
+		Easys::AsyncOperation<std::string> operation;
+		pending.emplace_back(std::move(path), operation);
+		return operation;
+	}
+
+	void completeAll()
+	{
+		for (auto& [path, operation] : std::exchange(pending, {})) operation.complete("data:" + path);
+	}
+
+	size_t size() const { return pending.size(); }
+
+   private:
+	std::vector<std::pair<std::string, Easys::AsyncOperation<std::string>>> pending;
+};
+
+struct AssetPath {
+	std::string path;
+};
+
+struct Asset {
+	std::string data;
+};
+
+using AsyncWorld = Easys::ECS<AssetPath, Asset>;
+
+Easys::Task loadAsset(AsyncWorld& world, FakeIo& io, Easys::Entity e)
+{
+	std::string data = co_await io.load(world.getComponent<AssetPath>(e).path);
+	world.addComponent(e, Asset{std::move(data)});
+}
+
+Easys::Task countTicks(int& ticks, int until)
+{
+	while (ticks < until)
+	{
+		co_await Easys::nextTick();
+		ticks++;
+	}
+}
+
+Easys::Task failAfterLoad(FakeIo& io)
+{
+	co_await io.load("broken");
+	throw std::runtime_error("load failed");
+}
+
+Easys::Task clearWorld(AsyncWorld& world)
+{
+	co_await Easys::nextTick();
+	world.clear();
+}
+
+}  // namespace
+
+TEST_CASE("Async tasks", "[ECS][Task]")
+{
+	AsyncWorld world;
+	FakeIo io;
+
+	SECTION("Tasks are suspended until their operation completes")
+	{
+		const auto e = world.addEntity();
+		world.addComponent(e, AssetPath{"tree.mesh"});
+		world.spawnTask(e, loadAsset(world, io, e));
+
+		REQUIRE(world.hasTask(e));
+		REQUIRE(io.size() == 1);
+		world.runTasks();
+		REQUIRE_FALSE(world.hasComponent<Asset>(e));
+
+		io.completeAll();
+		REQUIRE_FALSE(world.hasComponent<Asset>(e));  // resumed by the tick, not by the I/O source
+		world.runTasks();
+		REQUIRE(world.getComponent<Asset>(e).data == "data:tree.mesh");
+		REQUIRE_FALSE(world.hasTask(e));
+	}
+
+	SECTION("Async systems spawn one task per matching entity")
+	{
+		for (int i = 0; i < 10; i++) world.addComponent(world.addEntity(), AssetPath{std::to_string(i)});
+
+		const auto system = [&](Easys::Entity e) { return loadAsset(world, io, e); };
+		world.spawnTasks<AssetPath>(system);
+		world.spawnTasks<AssetPath>(system);
+		REQUIRE(world.getTaskCount() == 10);
+		REQUIRE(io.size() == 10);
+
+		io.completeAll();
+		world.runTasks();
+		REQUIRE(world.getTaskCount() == 0);
+		REQUIRE(world.getComponentCount<Asset>() == 10);
+	}
+
+	SECTION("Operations can complete on other threads")
+	{
+		const auto e = world.addEntity();
+		world.addComponent(e, AssetPath{"remote"});
+		world.spawnTask(e, loadAsset(world, io, e));
+
+		std::thread worker([&io] { io.completeAll(); });
+		worker.join();
+		world.runTasks();
+		REQUIRE(world.getComponent<Asset>(e).data == "data:remote");
+	}
+
+	SECTION("Removing an entity cancels its task")
+	{
+		const auto e = world.addEntity();
+		world.addComponent(e, AssetPath{"gone"});
+		world.spawnTask(e, loadAsset(world, io, e));
+		world.removeEntity(e);
+
+		REQUIRE_FALSE(world.hasTask(e));
+		io.completeAll();
+		world.runTasks();
+		REQUIRE(world.getComponentCount<Asset>() == 0);
+	}
+
+	SECTION("nextTick spreads work over several ticks")
+	{
+		int ticks = 0;
+		world.spawnTask(world.addEntity(), countTicks(ticks, 3));
+		for (int i = 0; i < 5; i++) world.runTasks();
+
+		REQUIRE(ticks == 3);
+		REQUIRE(world.getTaskCount() == 0);
+	}
+
+	SECTION("Exceptions are rethrown by runTasks")
+	{
+		const auto e = world.addEntity();
+		world.spawnTask(e, failAfterLoad(io));
+		io.completeAll();
+
+		REQUIRE_THROWS_WITH(world.runTasks(), "load failed");
+		REQUIRE_FALSE(world.hasTask(e));
+	}
+
+	SECTION("Spawning replaces the previous task of an entity")
+	{
+		const auto e = world.addEntity();
+		world.addComponent(e, AssetPath{"first"});
+		world.spawnTask(e, loadAsset(world, io, e));
+		world.getComponent<AssetPath>(e).path = "second";
+		world.spawnTask(e, loadAsset(world, io, e));
+
+		io.completeAll();
+		world.runTasks();
+		REQUIRE(world.getComponent<Asset>(e).data == "data:second");
+	}
+
+	SECTION("Worlds with pending tasks cannot be copied or moved")
+	{
+		const auto e = world.addEntity();
+		world.addComponent(e, AssetPath{"tree.mesh"});
+		world.spawnTask(e, loadAsset(world, io, e));
+
+		REQUIRE_THROWS_AS(AsyncWorld(world), std::logic_error);
+		REQUIRE_THROWS_AS(AsyncWorld(std::move(world)), std::logic_error);
+		AsyncWorld other;
+		REQUIRE_THROWS_AS(other = world, std::logic_error);
+		REQUIRE(world.getComponent<AssetPath>(e).path == "tree.mesh");  // the source is untouched
+
+		io.completeAll();
+		world.runTasks();
+		AsyncWorld moved(std::move(world));
+		REQUIRE(moved.getComponent<Asset>(e).data == "data:tree.mesh");
+		AsyncWorld copy(moved);
+		REQUIRE(copy.getComponent<Asset>(e).data == "data:tree.mesh");
+	}
+
+	SECTION("Clearing the world from within a task")
+	{
+		const auto e = world.addEntity();
+		int ticks = 0;
+		world.spawnTask(e, clearWorld(world));
+		world.spawnTask(world.addEntity(), countTicks(ticks, 10));
+		REQUIRE(world.getTaskCount() == 2);
+
+		world.runTasks();
+		REQUIRE(world.getTaskCount() == 0);
+		REQUIRE(world.getEntityCount() == 0);
+		REQUIRE(ticks == 0);
+	}
+}